@@ -0,0 +1,213 @@
+#include "pagerank.h"
+#include "spmv.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+// Priorities are bucketed by powers of two above the push threshold
+const int NUM_BUCKETS = 32;
+// Nodes taken from a queue per lock, and the most a thief takes at once
+const int BATCH_SIZE = 64;
+
+// Work of one thread. buckets[b] holds nodes whose priority reached about
+// 2^b times the threshold
+struct WorkQueue
+{
+    mutex lock;
+    vector<int> buckets[NUM_BUCKETS];
+    int64_t size = 0;
+};
+
+static int bucket_of(double priority, double threshold)
+{
+    return clamp(ilogb(priority / threshold), 0, NUM_BUCKETS - 1);
+}
+
+// Move up to BATCH_SIZE nodes of the best non-empty bucket into batch and
+// return that bucket, or -1 if the queue is empty
+// A thief takes at most half of it so the owner keeps some work
+static int take(WorkQueue &queue, vector<int> &batch, bool steal)
+{
+    lock_guard<mutex> guard(queue.lock);
+    for (int b = NUM_BUCKETS - 1; b >= 0 && queue.size > 0; b--)
+    {
+        vector<int> &bucket = queue.buckets[b];
+        if (bucket.empty())
+            continue;
+        int count = steal ? (bucket.size() + 1) / 2 : bucket.size();
+        count = min(count, BATCH_SIZE);
+        batch.insert(batch.end(), bucket.end() - count, bucket.end());
+        bucket.resize(bucket.size() - count);
+        queue.size -= count;
+        return b;
+    }
+    return -1;
+}
+
+// Same fixed point as power iteration: estimate solves
+//     estimate = (1 - d) / n + d * P^T estimate
+// with dangling mass dropped, which normalized is PageRank with uniform dangling
+// Pushing v moves residual[v] into estimate[v] and d * residual[v] / out_degree(v)
+// into the residual of each out-neighbor
+// The priority of v is |residual[v]| per out-edge, scaled by the average degree,
+// i.e. the mass a push moves per edge it reads. Nodes are pushed until every
+// priority is below tolerance / n, which bounds the sum of |residual| by about
+// tolerance like the pull kernel's stopping rule
+// A node whose priority grows into a higher bucket is queued again there and
+// its older entry goes stale, otherwise large residuals would wait behind small
+// ones and the pushes would stop following the largest priority
+void PageRank::async_iteration(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    double d = this->options.damping;
+    double threshold = this->options.tolerance / n;
+    double average_degree = max<double>(1.0, (double)graph.num_edges() / n);
+
+#ifdef _OPENMP
+    int threads = omp_get_max_threads();
+#else
+    int threads = 1;
+#endif
+
+    auto priority = [&](int v, double r)
+    {
+        return fabs(r) / max<int64_t>(1, graph.out_degree(v)) * average_degree;
+    };
+
+    // Warm start from the uniform vector like the other modes, one pull sweep
+    // gives the residuals of that starting point (some of them negative)
+    vector<double> estimate(n, 1.0 / n);
+    vector<double> residual(n);
+    auto initial_residual = [&](int v, double acc)
+    {
+        residual[v] = (1.0 - d) / n + d * acc - estimate[v];
+        return 0.0;
+    };
+    spmv<PlusTimes<double>, InverseOutDegree>(graph, estimate.data(), initial_residual);
+
+    // Bucket of the live queue entry of each node, -1 when it has none
+    vector<int8_t> queued(n, -1);
+    vector<WorkQueue> queues(threads);
+    int64_t initial = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        for (int v = t * (int64_t)n / threads; v < (t + 1) * (int64_t)n / threads; v++)
+        {
+            double p = priority(v, residual[v]);
+            if (p <= threshold)
+                continue;
+            queued[v] = bucket_of(p, threshold);
+            queues[t].buckets[queued[v]].push_back(v);
+            queues[t].size++;
+        }
+        initial += queues[t].size;
+    }
+
+    // Queue entries not processed yet, stale ones included
+    // The run is over once it reaches zero
+    atomic<int64_t> pending{initial};
+    atomic<int64_t> edges_processed{graph.num_edges()};
+    // Pushes stop early once they read as many edges as max_iterations
+    // iterations of power iteration would
+    int64_t edge_budget = (int64_t)this->options.max_iterations * graph.num_edges();
+    atomic<bool> out_of_budget{false};
+
+#pragma omp parallel num_threads(threads)
+    {
+#ifdef _OPENMP
+        int tid = omp_get_thread_num();
+#else
+        int tid = 0;
+#endif
+        vector<int> batch;
+        vector<pair<int, int>> activated;
+
+        while (!out_of_budget.load())
+        {
+            batch.clear();
+            int bucket = take(queues[tid], batch, false);
+            for (int i = 1; i < threads && bucket < 0; i++)
+                bucket = take(queues[(tid + i) % threads], batch, true);
+            if (bucket < 0)
+            {
+                if (pending.load() == 0)
+                    break;
+                this_thread::yield();
+                continue;
+            }
+
+            int64_t edges = 0;
+            for (int v : batch)
+            {
+                // Claim the node. Fails for stale entries, whose node was queued
+                // again in a higher bucket or already pushed since
+                int8_t current = bucket;
+                if (!atomic_ref<int8_t>(queued[v]).compare_exchange_strong(current, -1))
+                    continue;
+                double r = atomic_ref<double>(residual[v]).exchange(0.0);
+                atomic_ref<double>(estimate[v]).fetch_add(r);
+
+                int64_t begin = graph.out_offsets[v];
+                int64_t end = graph.out_offsets[v + 1];
+                if (begin == end)
+                    continue;
+                double share = d * r / (end - begin);
+                for (int64_t e = begin; e < end; e++)
+                {
+                    int w = graph.out_targets[e];
+                    double now = atomic_ref<double>(residual[w]).fetch_add(share) + share;
+                    double p = priority(w, now);
+                    if (p <= threshold)
+                        continue;
+                    int8_t target = bucket_of(p, threshold);
+                    int8_t previous = atomic_ref<int8_t>(queued[w]).load();
+                    while (previous < target && !atomic_ref<int8_t>(queued[w]).compare_exchange_weak(previous, target))
+                    {
+                    }
+                    if (previous < target)
+                    {
+                        pending.fetch_add(1);
+                        activated.push_back({w, target});
+                    }
+                }
+                edges += end - begin;
+            }
+
+            // New entries go to this thread's own queue
+            if (!activated.empty())
+            {
+                lock_guard<mutex> guard(queues[tid].lock);
+                for (auto [w, target] : activated)
+                    queues[tid].buckets[target].push_back(w);
+                queues[tid].size += activated.size();
+                activated.clear();
+            }
+            pending.fetch_sub(batch.size());
+            if (edges_processed.fetch_add(edges) + edges >= edge_budget)
+                out_of_budget.store(true);
+        }
+    }
+
+    double total = accumulate(estimate.begin(), estimate.end(), 0.0);
+#pragma omp parallel for
+    for (int v = 0; v < n; v++)
+        this->ranks[v] = estimate[v] / total;
+
+    this->stats.edges_processed = edges_processed.load();
+    double left = 0.0;
+    for (int v = 0; v < n; v++)
+        left += fabs(residual[v]);
+    this->stats.residual = left / total;
+    this->stats.converged = !out_of_budget.load() && this->stats.residual < this->options.tolerance;
+}
@@ -0,0 +1,165 @@
+#include "pagerank.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+// Kamvar et al. BlockRank, the block structure usually comes from web hosts
+void PageRank::block_iteration(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    if (graph.blocks.size() != n)
+    {
+        power_iteration(graph);
+        return;
+    }
+
+    double d = this->options.damping;
+    int num_blocks = graph.num_blocks();
+
+    // Group the nodes by block with a counting sort
+    vector<int> offsets(num_blocks + 1, 0);
+    for (int v = 0; v < n; v++)
+        offsets[graph.blocks[v] + 1]++;
+    for (int b = 0; b < num_blocks; b++)
+        offsets[b + 1] += offsets[b];
+    vector<int> nodes(n);
+    vector<int> local_index(n);
+    vector<int> position(offsets.begin(), offsets.end() - 1);
+    for (int v = 0; v < n; v++)
+    {
+        local_index[v] = position[graph.blocks[v]] - offsets[graph.blocks[v]];
+        nodes[position[graph.blocks[v]]++] = v;
+    }
+
+    // 1. Local PageRank of every block using only its internal edges
+    vector<double> local(n);
+    int local_iterations = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(max : local_iterations)
+    for (int b = 0; b < num_blocks; b++)
+    {
+        const int *members = nodes.data() + offsets[b];
+        int size = offsets[b + 1] - offsets[b];
+        vector<int> internal_degree(size, 0);
+        for (int i = 0; i < size; i++)
+        {
+            int u = members[i];
+            for (int64_t e = graph.out_offsets[u]; e < graph.out_offsets[u + 1]; e++)
+                internal_degree[i] += graph.blocks[graph.out_targets[e]] == b;
+        }
+
+        vector<double> x(size, 1.0 / size);
+        vector<double> next(size);
+        for (int it = 0; it < this->options.max_iterations; it++)
+        {
+            double dangling = 0.0;
+            for (int i = 0; i < size; i++)
+                dangling += internal_degree[i] == 0 ? x[i] : 0.0;
+
+            double base = (1.0 - d) / size + d * dangling / size;
+            double residual = 0.0;
+            for (int i = 0; i < size; i++)
+            {
+                int v = members[i];
+                double sum = 0.0;
+                for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; e++)
+                {
+                    int u = graph.in_sources[e];
+                    if (graph.blocks[u] == b)
+                        sum += x[local_index[u]] / internal_degree[local_index[u]];
+                }
+                next[i] = base + d * sum;
+                residual += fabs(next[i] - x[i]);
+            }
+            x.swap(next);
+            local_iterations = max(local_iterations, it + 1);
+            if (residual < this->options.tolerance)
+                break;
+        }
+
+        for (int i = 0; i < size; i++)
+            local[members[i]] = x[i];
+    }
+    this->stats.local_iterations = local_iterations;
+
+    // 2. Block graph: the weight of I -> J is the local rank flowing from I to J
+    // through the global transition matrix, sum of local[u] / out_degree(u)
+    // All out-edges of a node leave its own block, so each row is aggregated
+    // on its own from the block's members, then the rows are concatenated
+    vector<vector<pair<int, double>>> rows(num_blocks);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int b = 0; b < num_blocks; b++)
+    {
+        vector<pair<int, double>> &row = rows[b];
+        for (int i = offsets[b]; i < offsets[b + 1]; i++)
+        {
+            int u = nodes[i];
+            int degree = graph.out_degree(u);
+            for (int64_t e = graph.out_offsets[u]; e < graph.out_offsets[u + 1]; e++)
+                row.push_back({graph.blocks[graph.out_targets[e]], local[u] / degree});
+        }
+        sort(row.begin(), row.end(), [](const pair<int, double> &x, const pair<int, double> &y)
+             { return x.first < y.first; });
+        int merged = 0;
+        for (int i = 0; i < row.size(); i++)
+        {
+            if (merged > 0 && row[merged - 1].first == row[i].first)
+                row[merged - 1].second += row[i].second;
+            else
+                row[merged++] = row[i];
+        }
+        row.resize(merged);
+        row.shrink_to_fit();
+    }
+
+    vector<int64_t> row_offsets(num_blocks + 1, 0);
+    for (int b = 0; b < num_blocks; b++)
+        row_offsets[b + 1] = row_offsets[b] + rows[b].size();
+    vector<tuple<int, int, double>> block_edges(row_offsets[num_blocks]);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int b = 0; b < num_blocks; b++)
+    {
+        for (int i = 0; i < rows[b].size(); i++)
+            block_edges[row_offsets[b] + i] = {b, rows[b][i].first, rows[b][i].second};
+        vector<pair<int, double>>().swap(rows[b]);
+    }
+
+    // Rows of the block graph sum to less than 1 when a block has dangling
+    // nodes, the missing mass is spread uniformly like in the global solve
+    vector<double> out_weight(num_blocks, 0.0);
+    for (const auto &[from, to, weight] : block_edges)
+        out_weight[from] += weight;
+
+    vector<double> block_rank(num_blocks, 1.0 / num_blocks);
+    vector<double> next(num_blocks);
+    for (int it = 0; it < this->options.max_iterations; it++)
+    {
+        double leaked = 0.0;
+        for (int b = 0; b < num_blocks; b++)
+            leaked += block_rank[b] * (1.0 - out_weight[b]);
+
+        fill(next.begin(), next.end(), (1.0 - d) / num_blocks + d * leaked / num_blocks);
+        for (const auto &[from, to, weight] : block_edges)
+            next[to] += d * block_rank[from] * weight;
+
+        double residual = 0.0;
+        for (int b = 0; b < num_blocks; b++)
+            residual += fabs(next[b] - block_rank[b]);
+        block_rank.swap(next);
+        this->stats.block_iterations = it + 1;
+        if (residual < this->options.tolerance)
+            break;
+    }
+
+    // 3. Warm start the global solve from local rank times block rank
+    for (int v = 0; v < n; v++)
+        this->ranks[v] = local[v] * block_rank[graph.blocks[v]];
+    double total = accumulate(this->ranks.begin(), this->ranks.end(), 0.0);
+    for (double &r : this->ranks)
+        r /= total;
+
+    power_iteration(graph);
+}
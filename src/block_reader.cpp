@@ -0,0 +1,486 @@
+#include "block_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BLOCK_READER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace std;
+
+BlockReader::BlockReader(size_t block_size, int queue_depth, int parser_threads) : block_size{block_size},
+                                                                                   queue_depth{max(queue_depth, 1)},
+                                                                                   parser_threads{parser_threads},
+                                                                                   used_io_uring{false},
+                                                                                   fd{-1}
+{
+}
+
+BlockReader::~BlockReader()
+{
+    close();
+}
+
+bool BlockReader::open(const string &path)
+{
+    close();
+    this->path = path;
+#if defined(unix) || defined(__unix__) || defined(__unix)
+    this->fd = ::open(path.c_str(), O_RDONLY);
+#else
+    FILE *file = fopen(path.c_str(), "rb");
+    this->fd = file != nullptr ? 0 : -1;
+    if (file != nullptr)
+        fclose(file);
+#endif
+    if (this->fd < 0)
+    {
+        std::cout << "ERROR::BLOCK_READER::OPEN_FAILED\n"
+                  << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void BlockReader::close()
+{
+#if defined(unix) || defined(__unix__) || defined(__unix)
+    if (this->fd >= 0)
+        ::close(this->fd);
+#endif
+    this->fd = -1;
+}
+
+int64_t BlockReader::file_size() const
+{
+#if defined(unix) || defined(__unix__) || defined(__unix)
+    struct stat info;
+    if (this->fd < 0 || fstat(this->fd, &info) != 0)
+        return -1;
+    return info.st_size;
+#else
+    FILE *file = fopen(this->path.c_str(), "rb");
+    if (file == nullptr)
+        return -1;
+    _fseeki64(file, 0, SEEK_END);
+    int64_t size = _ftelli64(file);
+    fclose(file);
+    return size;
+#endif
+}
+
+bool BlockReader::scan(int64_t offset, int64_t length, const function<void(int64_t position, const char *data, size_t size)> &visit)
+{
+    this->used_io_uring = false;
+    if (this->fd < 0)
+        return false;
+    if (length <= 0)
+        return true;
+
+    int parsers = this->parser_threads > 0 ? this->parser_threads : max(1u, thread::hardware_concurrency());
+    bool ok;
+#ifdef BLOCK_READER_IO_URING
+    bool supported = false;
+    ok = scan_io_uring(offset, length, parsers, visit, supported);
+    this->used_io_uring = supported;
+    if (!supported)
+        ok = scan_pread(offset, length, max(parsers, this->queue_depth), visit);
+#else
+    ok = scan_pread(offset, length, max(parsers, this->queue_depth), visit);
+#endif
+
+    if (!ok)
+    {
+        std::cout << "ERROR::BLOCK_READER::READ_FAILED\n"
+                  << this->path << std::endl;
+    }
+    return ok;
+}
+
+// Each reader thread claims the next block, reads it and visits it itself
+bool BlockReader::scan_pread(int64_t offset, int64_t length, int readers, const function<void(int64_t, const char *, size_t)> &visit)
+{
+    int64_t blocks = (length + this->block_size - 1) / this->block_size;
+    atomic<int64_t> next{0};
+    atomic<bool> failed{false};
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+    auto read_blocks = [&]()
+    {
+        vector<char> buffer(this->block_size);
+        for (int64_t b = next++; b < blocks && !failed; b = next++)
+        {
+            int64_t position = offset + b * (int64_t)this->block_size;
+            size_t wanted = min<int64_t>(this->block_size, offset + length - position);
+            size_t got = 0;
+            while (got < wanted)
+            {
+                ssize_t result = pread(this->fd, buffer.data() + got, wanted - got, position + got);
+                if (result <= 0)
+                    break;
+                got += result;
+            }
+            if (got < wanted)
+            {
+                failed = true;
+                break;
+            }
+            visit(position, buffer.data(), wanted);
+        }
+    };
+
+    vector<thread> threads;
+    for (int t = 0; t < min<int64_t>(readers, blocks); t++)
+        threads.emplace_back(read_blocks);
+    for (thread &t : threads)
+        t.join();
+#else
+    FILE *file = fopen(this->path.c_str(), "rb");
+    if (file == nullptr || _fseeki64(file, offset, SEEK_SET) != 0)
+        failed = true;
+    vector<char> buffer(this->block_size);
+    for (int64_t b = 0; b < blocks && !failed; b++)
+    {
+        int64_t position = offset + b * (int64_t)this->block_size;
+        size_t wanted = min<int64_t>(this->block_size, offset + length - position);
+        if (fread(buffer.data(), 1, wanted, file) != wanted)
+            failed = true;
+        else
+            visit(position, buffer.data(), wanted);
+    }
+    if (file != nullptr)
+        fclose(file);
+#endif
+    return !failed;
+}
+
+#ifdef BLOCK_READER_IO_URING
+
+// Submission and completion rings shared with the kernel
+struct Ring
+{
+    int fd = -1;
+    void *sq_memory = MAP_FAILED;
+    size_t sq_bytes = 0;
+    void *cq_memory = MAP_FAILED;
+    size_t cq_bytes = 0;
+    io_uring_sqe *sqes = (io_uring_sqe *)MAP_FAILED;
+    size_t sqe_bytes = 0;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    io_uring_cqe *cqes;
+
+    ~Ring()
+    {
+        if (this->sqes != MAP_FAILED)
+            munmap(this->sqes, this->sqe_bytes);
+        if (this->cq_memory != MAP_FAILED && this->cq_memory != this->sq_memory)
+            munmap(this->cq_memory, this->cq_bytes);
+        if (this->sq_memory != MAP_FAILED)
+            munmap(this->sq_memory, this->sq_bytes);
+        if (this->fd >= 0)
+            ::close(this->fd);
+    }
+
+    bool setup(unsigned entries)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        this->fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (this->fd < 0)
+            return false;
+
+        this->sq_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        this->cq_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            this->sq_bytes = this->cq_bytes = max(this->sq_bytes, this->cq_bytes);
+
+        this->sq_memory = mmap(nullptr, this->sq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQ_RING);
+        if (this->sq_memory == MAP_FAILED)
+            return false;
+        this->cq_memory = this->sq_memory;
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+        {
+            this->cq_memory = mmap(nullptr, this->cq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_CQ_RING);
+            if (this->cq_memory == MAP_FAILED)
+                return false;
+        }
+        this->sqe_bytes = params.sq_entries * sizeof(io_uring_sqe);
+        this->sqes = (io_uring_sqe *)mmap(nullptr, this->sqe_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQES);
+        if (this->sqes == MAP_FAILED)
+            return false;
+
+        char *sq = (char *)this->sq_memory;
+        char *cq = (char *)this->cq_memory;
+        this->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+        this->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+        this->sq_array = (unsigned *)(sq + params.sq_off.array);
+        this->cq_head = (unsigned *)(cq + params.cq_off.head);
+        this->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+        this->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+        this->cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // IORING_OP_READ came with kernel 5.6, together with the opcode probe, so
+    // on 5.1-5.5 the probe itself fails and the ring is not used
+    bool supports_read()
+    {
+        const unsigned num_ops = 256;
+        vector<char> memory(sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op), 0);
+        io_uring_probe *probe = (io_uring_probe *)memory.data();
+        if (syscall(__NR_io_uring_register, this->fd, IORING_REGISTER_PROBE, probe, num_ops) < 0)
+            return false;
+        return IORING_OP_READ <= probe->last_op && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    // Queue a read, the caller keeps in-flight reads below the ring size
+    void read(int file, char *data, unsigned size, int64_t position, uint64_t tag)
+    {
+        unsigned tail = *this->sq_tail;
+        unsigned index = tail & *this->sq_mask;
+        io_uring_sqe &sqe = this->sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = file;
+        sqe.addr = (uint64_t)data;
+        sqe.len = size;
+        sqe.off = position;
+        sqe.user_data = tag;
+        this->sq_array[index] = index;
+        __atomic_store_n(this->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Submit the queued reads and wait for at least wait_for completions
+    // Returns how many reads the kernel consumed, it stops at the first one it
+    // rejects (that one completes with an error), or -1 on failure
+    int enter(unsigned submit, unsigned wait_for)
+    {
+        while (true)
+        {
+            int result = syscall(__NR_io_uring_enter, this->fd, submit, wait_for, wait_for > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (result >= 0)
+                return result;
+            if (errno != EINTR)
+                return -1;
+        }
+    }
+
+    // Next completion, false if none is ready
+    bool complete(uint64_t &tag, int &result)
+    {
+        unsigned head = *this->cq_head;
+        if (head == __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE))
+            return false;
+        io_uring_cqe &cqe = this->cqes[head & *this->cq_mask];
+        tag = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(this->cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+
+// This thread drives the ring: it keeps queue_depth block reads in flight and
+// moves every completed block to the parser threads, which return it once visited
+// supported is false when io_uring could not be set up, cannot read files or
+// rejected the first read, nothing was visited then
+bool BlockReader::scan_io_uring(int64_t offset, int64_t length, int parsers, const function<void(int64_t, const char *, size_t)> &visit, bool &supported)
+{
+    Ring ring;
+    supported = ring.setup(this->queue_depth) && ring.supports_read();
+    if (!supported)
+        return false;
+
+    int64_t blocks = (length + this->block_size - 1) / this->block_size;
+    int num_buffers = this->queue_depth + parsers;
+    vector<vector<char>> buffers(min<int64_t>(num_buffers, blocks), vector<char>(this->block_size));
+    // Per buffer: file offset of its block, bytes wanted and bytes read so far
+    vector<int64_t> positions(buffers.size());
+    vector<size_t> wanted(buffers.size());
+    vector<size_t> filled(buffers.size());
+
+    mutex lock;
+    condition_variable changed;
+    queue<int> free_buffers;
+    queue<int> ready_buffers;
+    for (int b = 0; b < buffers.size(); b++)
+        free_buffers.push(b);
+    bool done = false;
+    bool failed = false;
+
+    auto parse = [&]()
+    {
+        while (true)
+        {
+            int b;
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&]() { return !ready_buffers.empty() || done; });
+                if (ready_buffers.empty())
+                    return;
+                b = ready_buffers.front();
+                ready_buffers.pop();
+            }
+
+            visit(positions[b], buffers[b].data(), wanted[b]);
+
+            {
+                lock_guard<mutex> guard(lock);
+                free_buffers.push(b);
+            }
+            changed.notify_all();
+        }
+    };
+    vector<thread> threads;
+    for (int t = 0; t < parsers; t++)
+        threads.emplace_back(parse);
+
+    int64_t next_block = 0;
+    int in_flight = 0;
+    // Blocks are only handed to the parsers once the first one has been read,
+    // the ones finishing before it are parked. A rejected first read then
+    // leaves nothing visited, and the scan can start over with pread
+    bool first_read = false;
+    vector<int> parked;
+    bool rejected = false;
+    // Reads queued in the ring but not consumed by the kernel yet
+    unsigned pending = 0;
+    auto submit = [&](unsigned wait_for)
+    {
+        int submitted = ring.enter(pending, wait_for);
+        if (submitted < 0)
+            return false;
+        pending -= submitted;
+        return true;
+    };
+    auto deliver = [&](int b)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            ready_buffers.push(b);
+        }
+        changed.notify_all();
+    };
+    while (!failed && (next_block < blocks || in_flight > 0))
+    {
+        // Fill the ring with reads into free buffers
+        {
+            unique_lock<mutex> guard(lock);
+            if (in_flight == 0)
+                changed.wait(guard, [&]() { return !free_buffers.empty(); });
+            while (next_block < blocks && in_flight < this->queue_depth && !free_buffers.empty())
+            {
+                int b = free_buffers.front();
+                free_buffers.pop();
+                positions[b] = offset + next_block * (int64_t)this->block_size;
+                wanted[b] = min<int64_t>(this->block_size, offset + length - positions[b]);
+                filled[b] = 0;
+                ring.read(this->fd, buffers[b].data(), wanted[b], positions[b], b);
+                next_block++;
+                in_flight++;
+                pending++;
+            }
+        }
+
+        if (!submit(in_flight > 0 ? 1 : 0))
+        {
+            failed = true;
+            break;
+        }
+
+        uint64_t tag;
+        int result;
+        while (ring.complete(tag, result))
+        {
+            int b = tag;
+            bool first = positions[b] == offset;
+            if (result <= 0)
+            {
+                // An error, or the file ended before the range did
+                rejected |= first && filled[b] == 0 && (result == -EINVAL || result == -EOPNOTSUPP);
+                failed = true;
+                in_flight--;
+                continue;
+            }
+            filled[b] += result;
+            if (failed)
+            {
+                // Nothing more is visited after a failure, the reads only drain
+                in_flight--;
+                continue;
+            }
+            if (filled[b] < wanted[b])
+            {
+                // Short read, ask for the rest
+                ring.read(this->fd, buffers[b].data() + filled[b], wanted[b] - filled[b], positions[b] + filled[b], b);
+                pending++;
+                continue;
+            }
+
+            in_flight--;
+            if (!first_read && !first)
+            {
+                parked.push_back(b);
+                continue;
+            }
+            deliver(b);
+            if (first)
+            {
+                first_read = true;
+                for (int p : parked)
+                    deliver(p);
+                parked.clear();
+            }
+        }
+        if (!failed && pending > 0 && !submit(0))
+            failed = true;
+    }
+
+    // Reads the kernel took must land before the buffers go away, queued ones
+    // it never consumed do not start. Completions are still posted when
+    // entering the ring fails, so keep polling for them then
+    int outstanding = in_flight - pending;
+    while (outstanding > 0)
+    {
+        if (ring.enter(0, 1) < 0)
+            this_thread::yield();
+        uint64_t tag;
+        int result;
+        while (ring.complete(tag, result))
+            outstanding--;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        done = true;
+    }
+    changed.notify_all();
+    for (thread &t : threads)
+        t.join();
+    if (rejected)
+        supported = false;
+    return !failed;
+}
+#endif
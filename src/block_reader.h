@@ -0,0 +1,47 @@
+#ifndef BLOCK_READER_H
+#define BLOCK_READER_H
+#include <cstdint>
+#include <functional>
+#include <string>
+
+using namespace std;
+
+// Parallel reader for large binary files
+// A byte range is split into blocks. On Linux many block reads are kept in
+// flight through io_uring and every filled block is handed to a pool of parser
+// threads. Where io_uring is missing or refused, reader threads issue plain
+// pread calls instead (and a single thread reads sequentially off unix)
+// Blocks are visited concurrently and in no particular order
+class BlockReader
+{
+public:
+    // Bytes per read, 8MB by default
+    size_t block_size;
+    // Reads kept in flight
+    int queue_depth;
+    // Threads calling visit, 0 uses the hardware concurrency
+    int parser_threads;
+    // Whether the last scan went through io_uring
+    bool used_io_uring;
+
+    BlockReader(size_t block_size = 1 << 23, int queue_depth = 16, int parser_threads = 0);
+    ~BlockReader();
+
+    bool open(const string &path);
+    void close();
+    int64_t file_size() const;
+
+    // Read [offset, offset + length) and call visit(position, data, size) for
+    // every block, position being the file offset of data
+    // Blocks start at offset + k * block_size. Returns false on a read error or
+    // if the file ends early
+    bool scan(int64_t offset, int64_t length, const function<void(int64_t position, const char *data, size_t size)> &visit);
+
+private:
+    int fd;
+    string path;
+
+    bool scan_io_uring(int64_t offset, int64_t length, int parsers, const function<void(int64_t, const char *, size_t)> &visit, bool &supported);
+    bool scan_pread(int64_t offset, int64_t length, int readers, const function<void(int64_t, const char *, size_t)> &visit);
+};
+#endif
@@ -0,0 +1,58 @@
+#include "centrality.h"
+#include "spmv.h"
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+vector<double> katz_centrality(const CsrGraph &graph, double alpha, double tolerance, int max_iterations)
+{
+    vector<double> x(graph.num_nodes, 1.0);
+    vector<double> next(graph.num_nodes);
+
+    for (int it = 0; it < max_iterations; it++)
+    {
+        auto update = [&](int v, double incoming)
+        {
+            next[v] = alpha * incoming + 1.0;
+            return fabs(next[v] - x[v]);
+        };
+        double change = spmv<PlusTimes<double>>(graph, x.data(), update);
+        x.swap(next);
+        if (change < tolerance)
+            break;
+    }
+    return x;
+}
+
+// Level-synchronous BFS as repeated min-plus products: a node's level is the
+// smallest level among its in-neighbors plus one hop
+vector<int> bfs_levels(const CsrGraph &graph, int source)
+{
+    typedef MinPlus<int> Semiring;
+    vector<int> levels(graph.num_nodes, Semiring::zero());
+    if (source < 0 || source >= graph.num_nodes)
+        return vector<int>(graph.num_nodes, -1);
+    levels[source] = 0;
+
+    vector<int> next(graph.num_nodes);
+    for (int depth = 0; depth < graph.num_nodes; depth++)
+    {
+        auto relax = [&](int v, int reached)
+        {
+            next[v] = Semiring::add(levels[v], reached);
+            return next[v] != levels[v] ? 1.0 : 0.0;
+        };
+        double changed = spmv<Semiring, HopWeight>(graph, levels.data(), relax);
+        levels.swap(next);
+        if (changed == 0.0)
+            break;
+    }
+
+    for (int &level : levels)
+    {
+        if (level == Semiring::zero())
+            level = -1;
+    }
+    return levels;
+}
@@ -0,0 +1,14 @@
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+// Katz centrality: x = alpha * A^T x + 1, iterated until the L1 change drops
+// below tolerance. alpha must be smaller than 1 / (largest eigenvalue of A)
+vector<double> katz_centrality(const CsrGraph &graph, double alpha, double tolerance = 1e-8, int max_iterations = 100);
+
+// Number of hops from source to every node following out-edges, -1 if unreachable
+vector<int> bfs_levels(const CsrGraph &graph, int source);
+#endif
@@ -0,0 +1,167 @@
+#include "compressed_graph.h"
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+static int varint_size(uint64_t value)
+{
+    int size = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint8_t *write_varint(uint8_t *out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int num_skips(int degree, int block)
+{
+    return block > 0 && degree > 0 ? (degree - 1) / block : 0;
+}
+
+CompressedGraph::CompressedGraph() : num_nodes{0}, num_edges{0}, skip_interval{0}
+{
+}
+
+static const uint8_t *list_start(const vector<uint8_t> &data, const vector<int64_t> &bases, const vector<uint32_t> &offsets, int node)
+{
+    return data.data() + bases[node >> OFFSET_SAMPLE_BITS] + offsets[node];
+}
+
+// Encode every list of one direction, sizes first so lists are written in parallel
+static void encode(int num_nodes, const vector<int64_t> &offsets, const vector<int> &neighbors, int block,
+                   vector<int64_t> &bases, vector<uint32_t> &list_offsets, vector<uint8_t> &data)
+{
+    vector<int64_t> encoded_offsets(num_nodes + 1, 0);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < num_nodes; u++)
+    {
+        int degree = offsets[u + 1] - offsets[u];
+        int64_t size = varint_size(degree) + 4 * num_skips(degree, block);
+        for (int64_t e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            int i = e - offsets[u];
+            bool restart = block > 0 ? i % block == 0 : i == 0;
+            size += restart ? varint_size(zigzag((int64_t)neighbors[e] - u)) : varint_size(neighbors[e] - neighbors[e - 1]);
+        }
+        encoded_offsets[u + 1] = size;
+    }
+    for (int u = 0; u < num_nodes; u++)
+        encoded_offsets[u + 1] += encoded_offsets[u];
+    data.resize(encoded_offsets[num_nodes]);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < num_nodes; u++)
+    {
+        int degree = offsets[u + 1] - offsets[u];
+        uint8_t *out = write_varint(data.data() + encoded_offsets[u], degree);
+        uint8_t *skips = out;
+        uint8_t *start = out + 4 * num_skips(degree, block);
+        out = start;
+        for (int64_t e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            int i = e - offsets[u];
+            bool restart = block > 0 ? i % block == 0 : i == 0;
+            if (restart && i > 0)
+            {
+                uint32_t skip = out - start;
+                memcpy(skips + 4 * (i / block - 1), &skip, 4);
+            }
+            out = restart ? write_varint(out, zigzag((int64_t)neighbors[e] - u)) : write_varint(out, neighbors[e] - neighbors[e - 1]);
+        }
+    }
+
+    bases.resize((num_nodes >> OFFSET_SAMPLE_BITS) + 1);
+    list_offsets.resize(num_nodes);
+#pragma omp parallel for
+    for (int u = 0; u < num_nodes; u++)
+    {
+        int64_t base = encoded_offsets[u >> OFFSET_SAMPLE_BITS << OFFSET_SAMPLE_BITS];
+        if ((u & (OFFSET_SAMPLE - 1)) == 0)
+            bases[u >> OFFSET_SAMPLE_BITS] = base;
+        list_offsets[u] = encoded_offsets[u] - base;
+    }
+}
+
+CompressedGraph CompressedGraph::from_csr(const CsrGraph &graph, int skip_interval)
+{
+    CompressedGraph compressed;
+    compressed.num_nodes = graph.num_nodes;
+    compressed.num_edges = graph.num_edges();
+    compressed.skip_interval = skip_interval;
+    encode(graph.num_nodes, graph.out_offsets, graph.out_targets, skip_interval, compressed.out_bases, compressed.out_offsets, compressed.out_data);
+    encode(graph.num_nodes, graph.in_offsets, graph.in_sources, skip_interval, compressed.in_bases, compressed.in_offsets, compressed.in_data);
+    return compressed;
+}
+
+int CompressedGraph::out_degree(int node) const
+{
+    const uint8_t *p = list_start(this->out_data, this->out_bases, this->out_offsets, node);
+    return read_varint(p);
+}
+
+int CompressedGraph::in_degree(int node) const
+{
+    const uint8_t *p = list_start(this->in_data, this->in_bases, this->in_offsets, node);
+    return read_varint(p);
+}
+
+// Skip the degree and the skip table to the first neighbor
+static NeighborRange list_range(const uint8_t *p, int node, int block)
+{
+    int degree = read_varint(p);
+    p += 4 * num_skips(degree, block);
+    return {NeighborIterator(p, node, degree, block), NeighborIterator()};
+}
+
+NeighborRange CompressedGraph::out_neighbors(int node) const
+{
+    return list_range(list_start(this->out_data, this->out_bases, this->out_offsets, node), node, this->skip_interval);
+}
+
+NeighborRange CompressedGraph::in_neighbors(int node) const
+{
+    return list_range(list_start(this->in_data, this->in_bases, this->in_offsets, node), node, this->skip_interval);
+}
+
+int CompressedGraph::out_neighbor(int node, int i) const
+{
+    const uint8_t *p = list_start(this->out_data, this->out_bases, this->out_offsets, node);
+    int degree = read_varint(p);
+    int block = this->skip_interval > 0 ? this->skip_interval : degree;
+    const uint8_t *start = p + 4 * num_skips(degree, this->skip_interval);
+
+    // Jump to the block holding i, its first neighbor is stored relative to node
+    int k = i / block;
+    uint32_t skip = 0;
+    if (k > 0)
+        memcpy(&skip, p + 4 * (k - 1), 4);
+    NeighborIterator it(start + skip, node, degree - k * block, block);
+    for (int j = k * block; j < i; j++)
+        ++it;
+    return *it;
+}
+
+int64_t CompressedGraph::memory_bytes() const
+{
+    return (this->out_bases.size() + this->in_bases.size()) * sizeof(int64_t) +
+           (this->out_offsets.size() + this->in_offsets.size()) * sizeof(uint32_t) + this->out_data.size() + this->in_data.size();
+}
@@ -0,0 +1,68 @@
+#include "coo_graph.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+CooGraph::CooGraph() : num_nodes{0}
+{
+}
+
+// Position of (x, y) along the Hilbert curve filling a side x side square
+static uint64_t hilbert_index(uint64_t side, uint64_t x, uint64_t y)
+{
+    uint64_t index = 0;
+    for (uint64_t s = side / 2; s > 0; s /= 2)
+    {
+        uint64_t rx = (x & s) > 0;
+        uint64_t ry = (y & s) > 0;
+        index += s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so the curve stays continuous
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return index;
+}
+
+CooGraph CooGraph::from_csr(const CsrGraph &graph, EdgeOrder order)
+{
+    CooGraph coo;
+    coo.num_nodes = graph.num_nodes;
+    coo.edges.resize(graph.num_edges());
+
+#pragma omp parallel for
+    for (int u = 0; u < graph.num_nodes; u++)
+    {
+        for (int64_t e = graph.out_offsets[u]; e < graph.out_offsets[u + 1]; e++)
+            coo.edges[e] = {u, graph.out_targets[e]};
+    }
+
+    if (order == EdgeOrder::HILBERT)
+    {
+        uint64_t side = 1;
+        while (side < graph.num_nodes)
+            side *= 2;
+
+        vector<pair<uint64_t, Edge>> keyed(coo.edges.size());
+#pragma omp parallel for
+        for (int64_t e = 0; e < coo.edges.size(); e++)
+            keyed[e] = {hilbert_index(side, coo.edges[e].source, coo.edges[e].target), coo.edges[e]};
+
+        sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b)
+             { return a.first < b.first; });
+        for (int64_t e = 0; e < keyed.size(); e++)
+            coo.edges[e] = keyed[e].second;
+    }
+
+    return coo;
+}
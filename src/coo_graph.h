@@ -0,0 +1,29 @@
+#ifndef COO_GRAPH_H
+#define COO_GRAPH_H
+#include <vector>
+#include "csr_graph.h"
+#include "edge_file.h"
+
+using namespace std;
+
+enum class EdgeOrder
+{
+    // Grouped by source, the CSR out-edge order
+    SOURCE,
+    // Along a Hilbert curve over the (source, target) plane, so consecutive
+    // edges touch nearby sources and nearby targets
+    HILBERT
+};
+
+// Coordinate list representation, a flat array of arcs
+class CooGraph
+{
+public:
+    CooGraph();
+
+    int num_nodes;
+    vector<Edge> edges;
+
+    static CooGraph from_csr(const CsrGraph &graph, EdgeOrder order);
+};
+#endif
@@ -0,0 +1,397 @@
+#include "csr_graph.h"
+#include "block_reader.h"
+#include "edge_file.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+// Bits sorted per radix pass
+const int RADIX_BITS = 11;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+
+CsrGraph::CsrGraph() : num_nodes{0}
+{
+    this->out_offsets.assign(1, 0);
+    this->in_offsets.assign(1, 0);
+}
+
+CsrGraph CsrGraph::from_graph(const Graph &graph)
+{
+    vector<pair<int, int>> edges;
+    for (int u = 0; u < graph.adj_list.size(); u++)
+    {
+        for (int v : graph.adj_list[u])
+        {
+            edges.push_back({u, v});
+        }
+    }
+    return from_edges(graph.adj_list.size(), edges);
+}
+
+CsrGraph CsrGraph::from_edges(int num_nodes, const vector<pair<int, int>> &edges)
+{
+    CsrGraph csr;
+    csr.num_nodes = num_nodes;
+    csr.out_offsets.assign(num_nodes + 1, 0);
+    csr.in_offsets.assign(num_nodes + 1, 0);
+    csr.out_targets.resize(edges.size());
+    csr.in_sources.resize(edges.size());
+
+    // Count degrees, then turn the counts into offsets
+    for (const auto &[u, v] : edges)
+    {
+        csr.out_offsets[u + 1]++;
+        csr.in_offsets[v + 1]++;
+    }
+    for (int i = 0; i < num_nodes; i++)
+    {
+        csr.out_offsets[i + 1] += csr.out_offsets[i];
+        csr.in_offsets[i + 1] += csr.in_offsets[i];
+    }
+
+    // Scatter each arc into its slot
+    vector<int64_t> out_pos(csr.out_offsets.begin(), csr.out_offsets.end() - 1);
+    vector<int64_t> in_pos(csr.in_offsets.begin(), csr.in_offsets.end() - 1);
+    for (const auto &[u, v] : edges)
+    {
+        csr.out_targets[out_pos[u]++] = v;
+        csr.in_sources[in_pos[v]++] = u;
+    }
+
+    // Keep neighbor lists sorted so traversals are sequential in memory
+    for (int i = 0; i < num_nodes; i++)
+    {
+        sort(csr.out_targets.begin() + csr.out_offsets[i], csr.out_targets.begin() + csr.out_offsets[i + 1]);
+        sort(csr.in_sources.begin() + csr.in_offsets[i], csr.in_sources.begin() + csr.in_offsets[i + 1]);
+    }
+
+    return csr;
+}
+
+// LSD radix sort of the low key_bits bits of keys, buffer is scratch space
+// The keys are cut into contiguous blocks: each block counts its digits, the
+// counts are prefix-summed in (digit, block) order and each block scatters
+// its keys, which keeps every pass stable. Blocks are loop iterations rather
+// than thread ids, so the sort is right whatever team size it runs with
+static void radix_sort(vector<uint64_t> &keys, vector<uint64_t> &buffer, int key_bits)
+{
+    int64_t m = keys.size();
+    buffer.resize(m);
+#ifdef _OPENMP
+    int blocks = omp_get_max_threads();
+#else
+    int blocks = 1;
+#endif
+    vector<int64_t> counts((int64_t)blocks * RADIX_BUCKETS);
+
+    for (int shift = 0; shift < key_bits; shift += RADIX_BITS)
+    {
+#pragma omp parallel for
+        for (int b = 0; b < blocks; b++)
+        {
+            int64_t *count = &counts[(int64_t)b * RADIX_BUCKETS];
+            fill(count, count + RADIX_BUCKETS, 0);
+            for (int64_t i = m * b / blocks; i < m * (b + 1) / blocks; i++)
+                count[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+
+        int64_t total = 0;
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++)
+        {
+            for (int b = 0; b < blocks; b++)
+            {
+                int64_t c = counts[(int64_t)b * RADIX_BUCKETS + digit];
+                counts[(int64_t)b * RADIX_BUCKETS + digit] = total;
+                total += c;
+            }
+        }
+
+#pragma omp parallel for
+        for (int b = 0; b < blocks; b++)
+        {
+            int64_t *count = &counts[(int64_t)b * RADIX_BUCKETS];
+            for (int64_t i = m * b / blocks; i < m * (b + 1) / blocks; i++)
+                buffer[count[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++] = keys[i];
+        }
+        keys.swap(buffer);
+    }
+}
+
+// offsets of sorted keys grouped by key >> shift, and the low bits as neighbors
+// A node's offset is set by the first key of the next non-empty node after it
+static void fill_csr(const vector<uint64_t> &keys, int shift, int num_nodes, vector<int64_t> &offsets, vector<int> &neighbors)
+{
+    int64_t m = keys.size();
+    uint64_t mask = (uint64_t(1) << shift) - 1;
+    offsets.assign(num_nodes + 1, m);
+    neighbors.resize(m);
+
+#pragma omp parallel for
+    for (int64_t i = 0; i < m; i++)
+    {
+        neighbors[i] = keys[i] & mask;
+        int64_t node = keys[i] >> shift;
+        int64_t previous = i == 0 ? -1 : (int64_t)(keys[i - 1] >> shift);
+        for (int64_t u = previous + 1; u <= node; u++)
+            offsets[u] = i;
+    }
+}
+
+bool CsrGraph::from_unsorted_edges(int num_nodes, vector<pair<int, int>> edges, CsrGraph &csr)
+{
+    bool valid = true;
+#pragma omp parallel for reduction(&& : valid)
+    for (int64_t i = 0; i < edges.size(); i++)
+        valid = valid && edges[i].first >= 0 && edges[i].first < num_nodes && edges[i].second >= 0 && edges[i].second < num_nodes;
+    if (!valid)
+    {
+        std::cout << "ERROR::CSR_GRAPH::UNKNOWN_NODE\n"
+                  << "arc endpoint outside [0, " << num_nodes << ")" << std::endl;
+        return false;
+    }
+
+    int bits = 1;
+    while ((int64_t(1) << bits) < num_nodes)
+        bits++;
+
+    vector<uint64_t> keys(edges.size());
+#pragma omp parallel for
+    for (int64_t i = 0; i < edges.size(); i++)
+        keys[i] = (uint64_t)edges[i].first << bits | (uint64_t)edges[i].second;
+    vector<pair<int, int>>().swap(edges);
+
+    vector<uint64_t> buffer;
+    radix_sort(keys, buffer, 2 * bits);
+
+    // Keep the first of every run of equal keys unless it is a self-loop,
+    // compacting through a prefix sum of the kept counts per block
+#ifdef _OPENMP
+    int blocks = omp_get_max_threads();
+#else
+    int blocks = 1;
+#endif
+    int64_t m = keys.size();
+    uint64_t mask = (uint64_t(1) << bits) - 1;
+    vector<int64_t> kept(blocks + 1, 0);
+    auto keep = [&](int64_t i)
+    {
+        return (keys[i] >> bits) != (keys[i] & mask) && (i == 0 || keys[i] != keys[i - 1]);
+    };
+
+#pragma omp parallel for
+    for (int b = 0; b < blocks; b++)
+    {
+        int64_t count = 0;
+        for (int64_t i = m * b / blocks; i < m * (b + 1) / blocks; i++)
+            count += keep(i);
+        kept[b + 1] = count;
+    }
+    for (int b = 0; b < blocks; b++)
+        kept[b + 1] += kept[b];
+
+#pragma omp parallel for
+    for (int b = 0; b < blocks; b++)
+    {
+        int64_t position = kept[b];
+        for (int64_t i = m * b / blocks; i < m * (b + 1) / blocks; i++)
+        {
+            if (keep(i))
+                buffer[position++] = keys[i];
+        }
+    }
+    buffer.resize(kept[blocks]);
+    keys.swap(buffer);
+
+    csr.num_nodes = num_nodes;
+    fill_csr(keys, bits, num_nodes, csr.out_offsets, csr.out_targets);
+
+    // The same arcs keyed by (target, source) give the in-edges
+#pragma omp parallel for
+    for (int64_t i = 0; i < keys.size(); i++)
+        keys[i] = (keys[i] & mask) << bits | keys[i] >> bits;
+    radix_sort(keys, buffer, 2 * bits);
+    fill_csr(keys, bits, num_nodes, csr.in_offsets, csr.in_sources);
+
+    return true;
+}
+
+bool CsrGraph::from_edge_file(const string &path, CsrGraph &csr)
+{
+    EdgeFileHeader header;
+    {
+        EdgeStream stream;
+        if (!stream.open(path))
+            return false;
+        header = stream.header;
+    }
+
+    // Blocks are a multiple of the edge size apart, so none splits an edge
+    BlockReader reader;
+    if (!reader.open(path))
+        return false;
+    int64_t begin = sizeof(EdgeFileHeader);
+    int64_t bytes = header.num_edges * (int64_t)sizeof(Edge);
+
+    int n = header.num_nodes;
+    CsrGraph built;
+    built.num_nodes = n;
+    built.out_offsets.assign(n + 1, 0);
+    built.in_offsets.assign(n + 1, 0);
+
+    // Blocks arrive on several threads in any order, counts and cursors are atomic
+    atomic<bool> valid{true};
+    auto count_degrees = [&](int64_t position, const char *data, size_t size)
+    {
+        const Edge *edges = (const Edge *)data;
+        for (size_t i = 0; i < size / sizeof(Edge); i++)
+        {
+            if (edges[i].source < 0 || edges[i].source >= n || edges[i].target < 0 || edges[i].target >= n)
+            {
+                valid = false;
+                return;
+            }
+            atomic_ref<int64_t>(built.out_offsets[edges[i].source + 1]).fetch_add(1, memory_order_relaxed);
+            atomic_ref<int64_t>(built.in_offsets[edges[i].target + 1]).fetch_add(1, memory_order_relaxed);
+        }
+    };
+    if (!reader.scan(begin, bytes, count_degrees))
+        return false;
+    if (!valid)
+    {
+        std::cout << "ERROR::CSR_GRAPH::UNKNOWN_NODE\n"
+                  << path << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        built.out_offsets[i + 1] += built.out_offsets[i];
+        built.in_offsets[i + 1] += built.in_offsets[i];
+    }
+    built.out_targets.resize(built.out_offsets[n]);
+    built.in_sources.resize(built.in_offsets[n]);
+
+    // offsets[u] serves as the write cursor of u, afterwards it holds the
+    // start of u + 1 and shifting by one restores the offsets
+    auto scatter = [&](int64_t position, const char *data, size_t size)
+    {
+        const Edge *edges = (const Edge *)data;
+        for (size_t i = 0; i < size / sizeof(Edge); i++)
+        {
+            int64_t out = atomic_ref<int64_t>(built.out_offsets[edges[i].source]).fetch_add(1, memory_order_relaxed);
+            int64_t in = atomic_ref<int64_t>(built.in_offsets[edges[i].target]).fetch_add(1, memory_order_relaxed);
+            built.out_targets[out] = edges[i].target;
+            built.in_sources[in] = edges[i].source;
+        }
+    };
+    if (!reader.scan(begin, bytes, scatter))
+        return false;
+    for (int i = n; i > 0; i--)
+    {
+        built.out_offsets[i] = built.out_offsets[i - 1];
+        built.in_offsets[i] = built.in_offsets[i - 1];
+    }
+    built.out_offsets[0] = 0;
+    built.in_offsets[0] = 0;
+
+    // Sorting also undoes the arrival order of the blocks
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < n; i++)
+    {
+        sort(built.out_targets.begin() + built.out_offsets[i], built.out_targets.begin() + built.out_offsets[i + 1]);
+        sort(built.in_sources.begin() + built.in_offsets[i], built.in_sources.begin() + built.in_offsets[i + 1]);
+    }
+
+    csr = move(built);
+    return true;
+}
+
+int64_t CsrGraph::num_edges() const
+{
+    return this->out_targets.size();
+}
+
+int CsrGraph::out_degree(int node) const
+{
+    return this->out_offsets[node + 1] - this->out_offsets[node];
+}
+
+int CsrGraph::in_degree(int node) const
+{
+    return this->in_offsets[node + 1] - this->in_offsets[node];
+}
+
+vector<int> CsrGraph::partition(int parts) const
+{
+    vector<int> bounds(parts + 1, this->num_nodes);
+    bounds[0] = 0;
+
+    // Every node costs one unit plus one per in-edge it pulls
+    int64_t total = this->num_nodes + this->num_edges();
+    int node = 0;
+    for (int p = 1; p < parts; p++)
+    {
+        int64_t target = total * p / parts;
+        while (node < this->num_nodes && node + this->in_offsets[node] < target)
+            node++;
+        bounds[p] = node;
+    }
+    return bounds;
+}
+
+bool CsrGraph::read_blocks(const string &path)
+{
+    FILE *file = fopen(path.c_str(), "r");
+    if (file == nullptr)
+    {
+        std::cout << "ERROR::BLOCKS::OPEN_FAILED\n"
+                  << path << std::endl;
+        return false;
+    }
+
+    vector<int> blocks(this->num_nodes, -1);
+    int node, block;
+    int max_block = -1;
+    bool ok = true;
+    while (ok && fscanf(file, "%d %d", &node, &block) == 2)
+    {
+        ok = node >= 0 && node < this->num_nodes && block >= 0;
+        if (ok)
+        {
+            blocks[node] = block;
+            max_block = max(max_block, block);
+        }
+    }
+    ok &= feof(file) != 0;
+    fclose(file);
+    if (!ok)
+    {
+        std::cout << "ERROR::BLOCKS::BAD_LINE\n"
+                  << path << std::endl;
+        return false;
+    }
+
+    for (int &b : blocks)
+    {
+        if (b < 0)
+            b = ++max_block;
+    }
+    this->blocks.swap(blocks);
+    return true;
+}
+
+int CsrGraph::num_blocks() const
+{
+    int count = 0;
+    for (int b : this->blocks)
+        count = max(count, b + 1);
+    return count;
+}
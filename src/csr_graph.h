@@ -0,0 +1,59 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.h"
+
+using namespace std;
+
+// Compressed sparse row representation of a directed graph
+// The out-neighbors of node u are out_targets[out_offsets[u] .. out_offsets[u + 1])
+// and the in-neighbors of node v are in_sources[in_offsets[v] .. in_offsets[v + 1])
+class CsrGraph
+{
+public:
+    CsrGraph();
+
+    int num_nodes;
+    vector<int64_t> out_offsets;
+    vector<int> out_targets;
+    vector<int64_t> in_offsets;
+    vector<int> in_sources;
+    // Optional block (e.g. web host) of each node, empty when unknown
+    vector<int> blocks;
+
+    // Build from the adjacency list graph, every undirected edge becomes two arcs
+    static CsrGraph from_graph(const Graph &graph);
+
+    // Build from a list of (source, target) arcs
+    static CsrGraph from_edges(int num_nodes, const vector<pair<int, int>> &edges);
+
+    // Bulk build from an unsorted arc array, which is consumed. Arcs are packed
+    // into 64-bit (source, target) keys and radix-sorted in parallel, then
+    // self-loops and repeated arcs are dropped. Unlike from_edges the result
+    // is a simple graph. Returns false if an endpoint is outside [0, num_nodes)
+    static bool from_unsorted_edges(int num_nodes, vector<pair<int, int>> edges, CsrGraph &csr);
+
+    // Build from a binary edge file (see edge_file.h) in two streaming passes,
+    // one counting degrees and one scattering the arcs into the preallocated
+    // arrays, so no edge list is held in memory next to the graph
+    // Both passes read through BlockReader, with blocks parsed in parallel
+    // Returns false if the file cannot be read or names an unknown node
+    static bool from_edge_file(const string &path, CsrGraph &csr);
+
+    int64_t num_edges() const;
+    int out_degree(int node) const;
+    int in_degree(int node) const;
+
+    // Split the nodes into contiguous ranges with about the same number of
+    // nodes plus in-edges each. Range i is [bounds[i], bounds[i + 1])
+    vector<int> partition(int parts) const;
+
+    // Read the node to block mapping from a text file of "node block" lines
+    // Nodes missing from the file get a block of their own
+    bool read_blocks(const string &path);
+    int num_blocks() const;
+};
+#endif
@@ -0,0 +1,205 @@
+#include "pagerank.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// Sum the interleaved contributions flowing into v. K > 0 fixes k at compile
+// time so the k partial sums stay in registers across the edge loop
+template <int K>
+static inline void sweep_pull(const CsrGraph &graph, int k, const double *__restrict contrib, int v, double *__restrict sum)
+{
+    if constexpr (K > 0)
+    {
+        double local[K] = {};
+        for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; e++)
+        {
+            const double *c = contrib + graph.in_sources[e] * (size_t)K;
+            for (int j = 0; j < K; j++)
+                local[j] += c[j];
+        }
+        for (int j = 0; j < K; j++)
+            sum[j] = local[j];
+    }
+    else
+    {
+        fill(sum, sum + k, 0.0);
+        for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; e++)
+        {
+            const double *c = contrib + graph.in_sources[e] * (size_t)k;
+            for (int j = 0; j < k; j++)
+                sum[j] += c[j];
+        }
+    }
+}
+
+// One iteration over the interleaved vectors
+template <int K>
+static void sweep_iteration(const CsrGraph &graph, int k, const vector<double> &dampings, const vector<double> &base,
+                            const vector<double> &contrib, const vector<double> &ranks, vector<double> &next,
+                            vector<double> &residual)
+{
+    int n = graph.num_nodes;
+
+#pragma omp parallel
+    {
+        vector<double> sum(k);
+        vector<double> local_residual(k, 0.0);
+
+#pragma omp for
+        for (int v = 0; v < n; v++)
+        {
+            sweep_pull<K>(graph, k, contrib.data(), v, sum.data());
+
+            double *out = &next[v * (size_t)k];
+            const double *r = &ranks[v * (size_t)k];
+            for (int j = 0; j < k; j++)
+            {
+                out[j] = base[j] + dampings[j] * sum[j];
+                local_residual[j] += fabs(out[j] - r[j]);
+            }
+        }
+
+#pragma omp critical
+        for (int j = 0; j < k; j++)
+            residual[j] += local_residual[j];
+    }
+}
+
+vector<vector<double>> PageRank::run_damping_sweep(const CsrGraph &graph, const vector<double> &dampings)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = this->options.tolerance;
+    int n = graph.num_nodes;
+    vector<vector<double>> result(dampings.size());
+    if (n == 0 || dampings.empty())
+    {
+        this->stats.converged = true;
+        return result;
+    }
+
+    // Node-major layout: the k values of node v are ranks[v * k .. v * k + k)
+    // column[j] is the damping factor index held in slot j
+    int k = dampings.size();
+    vector<int> column(k);
+    vector<double> active_dampings = dampings;
+    for (int j = 0; j < k; j++)
+        column[j] = j;
+    vector<double> ranks(n * (size_t)k, 1.0 / n);
+    vector<double> next(n * (size_t)k);
+    vector<double> contrib(n * (size_t)k);
+
+    // Copy the ranks of slot j out to the result
+    auto extract = [&](int j)
+    {
+        result[column[j]].resize(n);
+        for (int v = 0; v < n; v++)
+            result[column[j]][v] = ranks[v * (size_t)k + j];
+    };
+
+    for (int it = 0; it < this->options.max_iterations && k > 0; it++)
+    {
+        vector<double> dangling(k, 0.0);
+        for (int u = 0; u < n; u++)
+        {
+            int degree = graph.out_degree(u);
+            const double *r = &ranks[u * (size_t)k];
+            double *c = &contrib[u * (size_t)k];
+            if (degree == 0)
+            {
+                for (int j = 0; j < k; j++)
+                {
+                    dangling[j] += r[j];
+                    c[j] = 0.0;
+                }
+            }
+            else
+            {
+                double inverse = 1.0 / degree;
+                for (int j = 0; j < k; j++)
+                    c[j] = r[j] * inverse;
+            }
+        }
+
+        vector<double> base(k);
+        vector<double> residual(k, 0.0);
+        for (int j = 0; j < k; j++)
+            base[j] = (1.0 - active_dampings[j]) / n + active_dampings[j] * dangling[j] / n;
+
+        switch (k)
+        {
+        case 1:
+            sweep_iteration<1>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 2:
+            sweep_iteration<2>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 3:
+            sweep_iteration<3>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 4:
+            sweep_iteration<4>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 5:
+            sweep_iteration<5>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 6:
+            sweep_iteration<6>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 7:
+            sweep_iteration<7>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        case 8:
+            sweep_iteration<8>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        default:
+            sweep_iteration<0>(graph, k, active_dampings, base, contrib, ranks, next, residual);
+            break;
+        }
+
+        ranks.swap(next);
+        this->stats.iterations++;
+        this->stats.edges_processed += graph.num_edges();
+        this->stats.residual = 0.0;
+        for (int j = 0; j < k; j++)
+            this->stats.residual = max(this->stats.residual, residual[j]);
+
+        // Converged vectors are dropped and the remaining ones repacked,
+        // so later iterations only move the values still in use
+        vector<int> kept;
+        for (int j = 0; j < k; j++)
+        {
+            if (residual[j] < this->options.tolerance)
+                extract(j);
+            else
+                kept.push_back(j);
+        }
+        if (kept.size() == k)
+            continue;
+
+        int new_k = kept.size();
+        for (int v = 0; v < n; v++)
+        {
+            for (int j = 0; j < new_k; j++)
+                next[v * (size_t)new_k + j] = ranks[v * (size_t)k + kept[j]];
+        }
+        for (int j = 0; j < new_k; j++)
+        {
+            column[j] = column[kept[j]];
+            active_dampings[j] = active_dampings[kept[j]];
+        }
+        k = new_k;
+        column.resize(k);
+        active_dampings.resize(k);
+        next.resize(n * (size_t)k);
+        ranks.swap(next);
+        next.resize(n * (size_t)k);
+        contrib.resize(n * (size_t)k);
+    }
+
+    this->stats.converged = k == 0;
+    for (int j = 0; j < k; j++)
+        extract(j);
+    return result;
+}
@@ -0,0 +1,710 @@
+#include "distributed_pagerank.h"
+#include "edge_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+
+// Every message is a type, a payload length and the payload itself
+enum MessageType : uint32_t
+{
+    // coordinator -> worker: worker index, node count, partition bounds, damping
+    MSG_ASSIGN = 1,
+    // coordinator -> worker: a chunk of edges whose source the worker owns
+    MSG_EDGES,
+    // coordinator -> worker: no more edges
+    MSG_EDGES_DONE,
+    // worker -> coordinator: for each partition, the remote targets it links to
+    MSG_TARGETS,
+    // coordinator -> worker: for each other worker, the ids its values will refer to
+    MSG_SOURCES,
+    // worker -> coordinator: last residual, compute time, dangling rank, outgoing values
+    MSG_STEP,
+    // coordinator -> worker: total dangling rank and the incoming values
+    MSG_INCOMING,
+    // coordinator -> worker: stop iterating and send the ranks back
+    MSG_FINISH,
+    // worker -> coordinator: ranks of the owned nodes
+    MSG_RANKS
+};
+
+// Byte buffer with sequential put/get of plain values
+// Sizes come from the peer, so a get past the end reads nothing, returns
+// zeros and sets failed, which the caller checks before using the values
+class MessageBuffer
+{
+public:
+    vector<char> data;
+    size_t read_pos = 0;
+    bool failed = false;
+
+    template <typename T>
+    void put(T value)
+    {
+        put_array(&value, 1);
+    }
+
+    template <typename T>
+    void put_array(const T *values, size_t count)
+    {
+        const char *bytes = (const char *)values;
+        data.insert(data.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    template <typename T>
+    T get()
+    {
+        T value{};
+        get_array(&value, 1);
+        return value;
+    }
+
+    template <typename T>
+    void get_array(T *values, size_t count)
+    {
+        if (failed || count > remaining<T>())
+        {
+            failed = true;
+            return;
+        }
+        memcpy(values, data.data() + read_pos, sizeof(T) * count);
+        read_pos += sizeof(T) * count;
+    }
+
+    // Values of type T left to read
+    template <typename T>
+    size_t remaining() const
+    {
+        return (data.size() - read_pos) / sizeof(T);
+    }
+};
+
+static bool send_all(int fd, const char *bytes, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, char *bytes, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t got = recv(fd, bytes, size, 0);
+        if (got <= 0)
+            return false;
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+static bool send_message(int fd, uint32_t type, const MessageBuffer &message)
+{
+    uint64_t size = message.data.size();
+    return send_all(fd, (const char *)&type, sizeof(type)) &&
+           send_all(fd, (const char *)&size, sizeof(size)) &&
+           send_all(fd, message.data.data(), size);
+}
+
+static bool recv_any_message(int fd, uint32_t &type, MessageBuffer &message)
+{
+    uint64_t size = 0;
+    if (!recv_all(fd, (char *)&type, sizeof(type)) || !recv_all(fd, (char *)&size, sizeof(size)))
+        return false;
+    message.data.resize(size);
+    message.read_pos = 0;
+    message.failed = false;
+    return recv_all(fd, message.data.data(), size);
+}
+
+// Receive the next message and check it has the expected type
+static bool recv_message(int fd, uint32_t expected, MessageBuffer &message)
+{
+    uint32_t type = 0;
+    if (!recv_any_message(fd, type, message))
+        return false;
+    if (type != expected)
+    {
+        std::cout << "ERROR::DISTRIBUTED::UNEXPECTED_MESSAGE\n"
+                  << type << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void set_no_delay(int fd)
+{
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static double seconds_since(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+PageRankCoordinator::PageRankCoordinator(PageRankOptions options) : options{options},
+                                                                    listen_fd{-1},
+                                                                    bound_port{0}
+{
+}
+
+PageRankCoordinator::~PageRankCoordinator()
+{
+    if (this->listen_fd >= 0)
+        close(this->listen_fd);
+}
+
+bool PageRankCoordinator::listen(int port)
+{
+    this->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(this->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (this->listen_fd < 0 ||
+        ::bind(this->listen_fd, (sockaddr *)&address, sizeof(address)) != 0 ||
+        ::listen(this->listen_fd, SOMAXCONN) != 0 ||
+        getsockname(this->listen_fd, (sockaddr *)&address, &length) != 0)
+    {
+        std::cout << "ERROR::DISTRIBUTED::LISTEN_FAILED\n"
+                  << port << std::endl;
+        return false;
+    }
+    this->bound_port = ntohs(address.sin_port);
+    return true;
+}
+
+int PageRankCoordinator::port() const
+{
+    return this->bound_port;
+}
+
+bool PageRankCoordinator::run(const string &edge_file, int num_workers)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = this->options.tolerance;
+    this->timings.clear();
+    this->ranks.clear();
+
+    EdgeStream stream;
+    if (this->listen_fd < 0 || !stream.open(edge_file))
+        return false;
+    int n = stream.header.num_nodes;
+    int workers = max(1, min(num_workers, max(n, 1)));
+
+    // Balance the partitions on nodes plus out-edges, like CsrGraph::partition
+    // Ids are checked here, before they pick a worker or index a worker's arrays
+    vector<int64_t> degree_prefix(n + 1, 0);
+    bool valid = true;
+    auto count_degrees = [&](const Edge *edges, size_t count)
+    {
+        for (size_t i = 0; i < count && valid; i++)
+        {
+            if (edges[i].source < 0 || edges[i].source >= n || edges[i].target < 0 || edges[i].target >= n)
+                valid = false;
+            else
+                degree_prefix[edges[i].source + 1]++;
+        }
+    };
+    if (!stream.scan(count_degrees))
+        return false;
+    if (!valid)
+    {
+        std::cout << "ERROR::DISTRIBUTED::EDGE_OUT_OF_RANGE\n"
+                  << edge_file << std::endl;
+        return false;
+    }
+    for (int v = 0; v < n; v++)
+        degree_prefix[v + 1] += degree_prefix[v];
+
+    vector<int> bounds(workers + 1, n);
+    bounds[0] = 0;
+    int64_t total = n + stream.header.num_edges;
+    int node = 0;
+    for (int p = 1; p < workers; p++)
+    {
+        while (node < n && node + degree_prefix[node] < total * p / workers)
+            node++;
+        bounds[p] = node;
+    }
+    degree_prefix.clear();
+    degree_prefix.shrink_to_fit();
+
+    vector<int> sockets;
+    auto close_all = [&]()
+    {
+        for (int fd : sockets)
+            close(fd);
+    };
+    for (int w = 0; w < workers; w++)
+    {
+        int fd = accept(this->listen_fd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            std::cout << "ERROR::DISTRIBUTED::ACCEPT_FAILED" << std::endl;
+            close_all();
+            return false;
+        }
+        set_no_delay(fd);
+        sockets.push_back(fd);
+
+        MessageBuffer assign;
+        assign.put<int32_t>(w);
+        assign.put<int32_t>(workers);
+        assign.put<int32_t>(n);
+        assign.put_array(bounds.data(), bounds.size());
+        assign.put<double>(this->options.damping);
+        if (!send_message(fd, MSG_ASSIGN, assign))
+        {
+            close_all();
+            return false;
+        }
+    }
+
+    // Workers beyond one per node get no partition, they are told to stop
+    // instead of waiting for an assignment forever
+    for (int w = workers; w < num_workers; w++)
+    {
+        int fd = accept(this->listen_fd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            std::cout << "ERROR::DISTRIBUTED::ACCEPT_FAILED" << std::endl;
+            close_all();
+            return false;
+        }
+        send_message(fd, MSG_FINISH, MessageBuffer());
+        close(fd);
+    }
+
+    // Route every edge to the worker owning its source, batched per worker
+    bool ok = true;
+    vector<MessageBuffer> batches(workers);
+    auto route_edges = [&](const Edge *edges, size_t count)
+    {
+        for (size_t i = 0; i < count && ok; i++)
+        {
+            int w = upper_bound(bounds.begin(), bounds.end(), edges[i].source) - bounds.begin() - 1;
+            batches[w].put(edges[i]);
+            if (batches[w].data.size() >= (1 << 20))
+            {
+                ok &= send_message(sockets[w], MSG_EDGES, batches[w]);
+                batches[w].data.clear();
+            }
+        }
+    };
+    ok &= stream.scan(route_edges);
+    for (int w = 0; w < workers && ok; w++)
+    {
+        ok &= send_message(sockets[w], MSG_EDGES, batches[w]);
+        ok &= send_message(sockets[w], MSG_EDGES_DONE, MessageBuffer());
+    }
+    batches.clear();
+    stream.close();
+
+    // counts[s][p] values flow from worker s to worker p every iteration
+    vector<vector<int64_t>> counts(workers, vector<int64_t>(workers, 0));
+    vector<vector<MessageBuffer>> target_ids(workers, vector<MessageBuffer>(workers));
+    for (int s = 0; s < workers && ok; s++)
+    {
+        MessageBuffer targets;
+        ok &= recv_message(sockets[s], MSG_TARGETS, targets);
+        for (int p = 0; p < workers && ok; p++)
+        {
+            counts[s][p] = targets.get<int64_t>();
+            ok &= !targets.failed && counts[s][p] >= 0 && counts[s][p] <= targets.remaining<int32_t>();
+            if (!ok)
+                break;
+            vector<int32_t> ids(counts[s][p]);
+            targets.get_array(ids.data(), ids.size());
+            for (int32_t v : ids)
+                ok &= v >= bounds[p] && v < bounds[p + 1];
+            target_ids[s][p].put_array(ids.data(), ids.size());
+        }
+    }
+    for (int p = 0; p < workers && ok; p++)
+    {
+        MessageBuffer sources;
+        for (int s = 0; s < workers; s++)
+        {
+            sources.put<int64_t>(counts[s][p]);
+            sources.data.insert(sources.data.end(), target_ids[s][p].data.begin(), target_ids[s][p].data.end());
+        }
+        ok &= send_message(sockets[p], MSG_SOURCES, sources);
+    }
+    target_ids.clear();
+
+    // Each STEP carries the residual of the previous update, so convergence is
+    // decided one message after the last ranks were computed
+    vector<MessageBuffer> steps(workers);
+    auto iteration_start = chrono::steady_clock::now();
+    for (int it = 0; ok; it++)
+    {
+        double residual = 0.0;
+        double dangling = 0.0;
+        double compute = 0.0;
+        for (int s = 0; s < workers && ok; s++)
+        {
+            ok &= recv_message(sockets[s], MSG_STEP, steps[s]);
+            residual += steps[s].get<double>();
+            compute = max(compute, steps[s].get<double>());
+            dangling += steps[s].get<double>();
+            int64_t values = 0;
+            for (int p = 0; p < workers; p++)
+                values += counts[s][p];
+            ok &= !steps[s].failed && steps[s].remaining<double>() == values;
+        }
+        if (!ok)
+            break;
+
+        if (it > 0)
+        {
+            double elapsed = seconds_since(iteration_start);
+            this->timings.push_back({compute, max(0.0, elapsed - compute)});
+            this->stats.iterations = it;
+            this->stats.residual = residual;
+            this->stats.edges_processed += total - n;
+            if (residual < this->options.tolerance)
+                this->stats.converged = true;
+        }
+        iteration_start = chrono::steady_clock::now();
+
+        if (this->stats.converged || it == this->options.max_iterations)
+            break;
+
+        // Values from worker s to worker p sit in s's STEP message in partition order
+        for (int p = 0; p < workers && ok; p++)
+        {
+            MessageBuffer incoming;
+            incoming.put<double>(dangling);
+            for (int s = 0; s < workers; s++)
+            {
+                size_t offset = steps[s].read_pos;
+                for (int q = 0; q < p; q++)
+                    offset += counts[s][q] * sizeof(double);
+                const char *begin = steps[s].data.data() + offset;
+                incoming.data.insert(incoming.data.end(), begin, begin + counts[s][p] * sizeof(double));
+            }
+            ok &= send_message(sockets[p], MSG_INCOMING, incoming);
+        }
+    }
+
+    if (ok)
+    {
+        this->ranks.assign(n, 0.0);
+        for (int w = 0; w < workers && ok; w++)
+        {
+            MessageBuffer result;
+            ok &= send_message(sockets[w], MSG_FINISH, MessageBuffer());
+            ok &= recv_message(sockets[w], MSG_RANKS, result);
+            if (ok)
+                result.get_array(this->ranks.data() + bounds[w], bounds[w + 1] - bounds[w]);
+            ok &= !result.failed;
+        }
+    }
+
+    if (!ok)
+        std::cout << "ERROR::DISTRIBUTED::WORKER_LOST" << std::endl;
+    close_all();
+    return ok;
+}
+
+// State of one worker: it owns the nodes in [begin, end) and their out-edges
+struct WorkerPartition
+{
+    int index;
+    int workers;
+    int num_nodes;
+    vector<int> bounds;
+    double damping;
+    int begin;
+    int end;
+
+    // Local CSR of the owned out-edges, each edge points at a slot of the
+    // accumulator: owned targets first, then the remote targets by partition
+    vector<int64_t> offsets;
+    vector<int64_t> edge_slot;
+    // For each other worker, the owned nodes its values are meant for
+    vector<vector<int32_t>> incoming_ids;
+};
+
+static bool run_worker(int fd)
+{
+    WorkerPartition part;
+    MessageBuffer message;
+    uint32_t first_type = 0;
+    if (!recv_any_message(fd, first_type, message))
+        return false;
+    // A coordinator with more workers than nodes lets the extra ones go
+    if (first_type == MSG_FINISH)
+        return true;
+    if (first_type != MSG_ASSIGN)
+        return false;
+    part.index = message.get<int32_t>();
+    part.workers = message.get<int32_t>();
+    part.num_nodes = message.get<int32_t>();
+    if (message.failed || part.workers <= 0 || part.workers > message.remaining<int32_t>() ||
+        part.index < 0 || part.index >= part.workers || part.num_nodes < 0)
+        return false;
+    part.bounds.resize(part.workers + 1);
+    message.get_array(part.bounds.data(), part.bounds.size());
+    part.damping = message.get<double>();
+    if (message.failed || part.bounds[0] != 0 || part.bounds[part.workers] != part.num_nodes ||
+        !is_sorted(part.bounds.begin(), part.bounds.end()))
+        return false;
+    part.begin = part.bounds[part.index];
+    part.end = part.bounds[part.index + 1];
+    int owned = part.end - part.begin;
+
+    vector<Edge> edges;
+    while (true)
+    {
+        uint32_t type = 0;
+        if (!recv_any_message(fd, type, message))
+            return false;
+        if (type == MSG_EDGES_DONE)
+            break;
+        if (type != MSG_EDGES)
+            return false;
+        size_t old_size = edges.size();
+        edges.resize(old_size + message.remaining<Edge>());
+        message.get_array(edges.data() + old_size, edges.size() - old_size);
+        for (size_t i = old_size; i < edges.size(); i++)
+        {
+            if (edges[i].source < part.begin || edges[i].source >= part.end || edges[i].target < 0 || edges[i].target >= part.num_nodes)
+                return false;
+        }
+    }
+
+    // Counting sort of the owned edges by source
+    part.offsets.assign(owned + 1, 0);
+    for (const Edge &e : edges)
+        part.offsets[e.source - part.begin + 1]++;
+    for (int u = 0; u < owned; u++)
+        part.offsets[u + 1] += part.offsets[u];
+
+    vector<int32_t> targets(edges.size());
+    vector<int64_t> position(part.offsets.begin(), part.offsets.end() - 1);
+    for (const Edge &e : edges)
+        targets[position[e.source - part.begin]++] = e.target;
+    edges.clear();
+    edges.shrink_to_fit();
+
+    // Distinct remote targets, sorted so each partition is a contiguous run
+    vector<int32_t> remote;
+    for (int32_t t : targets)
+        if (t < part.begin || t >= part.end)
+            remote.push_back(t);
+    sort(remote.begin(), remote.end());
+    remote.erase(unique(remote.begin(), remote.end()), remote.end());
+
+    part.edge_slot.resize(targets.size());
+    for (size_t e = 0; e < targets.size(); e++)
+    {
+        int32_t t = targets[e];
+        if (t >= part.begin && t < part.end)
+            part.edge_slot[e] = t - part.begin;
+        else
+            part.edge_slot[e] = owned + (lower_bound(remote.begin(), remote.end(), t) - remote.begin());
+    }
+    targets.clear();
+    targets.shrink_to_fit();
+
+    MessageBuffer announce;
+    for (int p = 0; p < part.workers; p++)
+    {
+        auto first = lower_bound(remote.begin(), remote.end(), part.bounds[p]);
+        auto last = lower_bound(remote.begin(), remote.end(), part.bounds[p + 1]);
+        announce.put<int64_t>(last - first);
+        announce.put_array(remote.data() + (first - remote.begin()), last - first);
+    }
+    if (!send_message(fd, MSG_TARGETS, announce))
+        return false;
+
+    if (!recv_message(fd, MSG_SOURCES, message))
+        return false;
+    part.incoming_ids.resize(part.workers);
+    int64_t incoming_values = 0;
+    for (int s = 0; s < part.workers; s++)
+    {
+        int64_t count = message.get<int64_t>();
+        if (message.failed || count < 0 || count > message.remaining<int32_t>())
+            return false;
+        part.incoming_ids[s].resize(count);
+        message.get_array(part.incoming_ids[s].data(), count);
+        for (int32_t v : part.incoming_ids[s])
+        {
+            if (v < part.begin || v >= part.end)
+                return false;
+        }
+        incoming_values += count;
+    }
+
+    int n = part.num_nodes;
+    double d = part.damping;
+    vector<double> ranks(owned, 1.0 / n);
+    vector<double> accumulator(owned + remote.size());
+    double residual = 0.0;
+    double update_seconds = 0.0;
+    remote.clear();
+
+    while (true)
+    {
+        // Push the owned contributions into the accumulator slots
+        auto compute_start = chrono::steady_clock::now();
+        fill(accumulator.begin(), accumulator.end(), 0.0);
+        double dangling = 0.0;
+        for (int u = 0; u < owned; u++)
+        {
+            int64_t degree = part.offsets[u + 1] - part.offsets[u];
+            if (degree == 0)
+            {
+                dangling += ranks[u];
+                continue;
+            }
+            double contrib = ranks[u] / degree;
+            for (int64_t e = part.offsets[u]; e < part.offsets[u + 1]; e++)
+                accumulator[part.edge_slot[e]] += contrib;
+        }
+        double compute = update_seconds + seconds_since(compute_start);
+
+        MessageBuffer step;
+        step.put<double>(residual);
+        step.put<double>(compute);
+        step.put<double>(dangling);
+        step.put_array(accumulator.data() + owned, accumulator.size() - owned);
+        if (!send_message(fd, MSG_STEP, step))
+            return false;
+
+        uint32_t type = 0;
+        if (!recv_any_message(fd, type, message))
+            return false;
+        if (type == MSG_FINISH)
+        {
+            MessageBuffer result;
+            result.put_array(ranks.data(), ranks.size());
+            return send_message(fd, MSG_RANKS, result);
+        }
+        if (type != MSG_INCOMING)
+            return false;
+
+        compute_start = chrono::steady_clock::now();
+        double dangling_total = message.get<double>();
+        if (message.failed || message.remaining<double>() != incoming_values)
+            return false;
+        for (int s = 0; s < part.workers; s++)
+        {
+            for (int32_t v : part.incoming_ids[s])
+                accumulator[v - part.begin] += message.get<double>();
+        }
+
+        double base = (1.0 - d) / n + d * dangling_total / n;
+        residual = 0.0;
+        for (int v = 0; v < owned; v++)
+        {
+            double next = base + d * accumulator[v];
+            residual += fabs(next - ranks[v]);
+            ranks[v] = next;
+        }
+        update_seconds = seconds_since(compute_start);
+    }
+}
+
+bool run_pagerank_worker(const string &host, int port)
+{
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &addresses) != 0)
+    {
+        std::cout << "ERROR::DISTRIBUTED::RESOLVE_FAILED\n"
+                  << host << std::endl;
+        return false;
+    }
+
+    int fd = -1;
+    for (addrinfo *a = addresses; a != nullptr && fd < 0; a = a->ai_next)
+    {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0)
+    {
+        std::cout << "ERROR::DISTRIBUTED::CONNECT_FAILED\n"
+                  << host << ":" << port << std::endl;
+        return false;
+    }
+
+    set_no_delay(fd);
+    bool ok = run_worker(fd);
+    close(fd);
+    return ok;
+}
+
+#else
+
+PageRankCoordinator::PageRankCoordinator(PageRankOptions options) : options{options},
+                                                                    listen_fd{-1},
+                                                                    bound_port{0}
+{
+}
+
+PageRankCoordinator::~PageRankCoordinator()
+{
+}
+
+bool PageRankCoordinator::listen(int port)
+{
+    std::cout << "ERROR::DISTRIBUTED::UNSUPPORTED_PLATFORM" << std::endl;
+    return false;
+}
+
+int PageRankCoordinator::port() const
+{
+    return this->bound_port;
+}
+
+bool PageRankCoordinator::run(const string &edge_file, int num_workers)
+{
+    return false;
+}
+
+bool run_pagerank_worker(const string &host, int port)
+{
+    std::cout << "ERROR::DISTRIBUTED::UNSUPPORTED_PLATFORM" << std::endl;
+    return false;
+}
+
+#endif
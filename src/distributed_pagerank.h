@@ -0,0 +1,47 @@
+#ifndef DISTRIBUTED_PAGERANK_H
+#define DISTRIBUTED_PAGERANK_H
+#include <string>
+#include <vector>
+#include "pagerank.h"
+
+using namespace std;
+
+// Time spent in one iteration, compute is the slowest worker's local work
+// and communication is everything else (sending, routing and waiting)
+struct IterationTiming
+{
+    double compute_seconds;
+    double communication_seconds;
+};
+
+// Coordinator of a PageRank run over TCP workers
+// Each worker owns a contiguous range of nodes and the out-edges leaving it.
+// Per iteration a worker only sends one aggregated value per remote node it
+// links to, and the coordinator routes those values to the owning workers
+class PageRankCoordinator
+{
+public:
+    PageRankOptions options;
+    PageRankStats stats;
+    vector<IterationTiming> timings;
+    vector<double> ranks;
+
+    PageRankCoordinator(PageRankOptions options);
+    ~PageRankCoordinator();
+
+    // Start listening, port 0 picks a free one (see port())
+    bool listen(int port);
+    int port() const;
+
+    // Accept num_workers workers, hand out the edges of the edge file
+    // (see edge_file.h) and iterate until convergence
+    bool run(const string &edge_file, int num_workers);
+
+private:
+    int listen_fd;
+    int bound_port;
+};
+
+// Connect to a coordinator and serve one PageRank run
+bool run_pagerank_worker(const string &host, int port);
+#endif
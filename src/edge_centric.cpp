@@ -0,0 +1,176 @@
+#include "pagerank.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+// Target ranges per thread, so a range with a hub can be balanced by the others
+const int RANGES_PER_THREAD = 8;
+
+void PageRank::edge_centric_iteration(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    double d = this->options.damping;
+    CooGraph coo = CooGraph::from_csr(graph, this->options.edge_order);
+    int64_t m = coo.edges.size();
+
+#ifdef _OPENMP
+    int threads = omp_get_max_threads();
+#else
+    int threads = 1;
+#endif
+
+    // Split the targets into ranges of about equal nodes plus in-edges and
+    // group the edges by the range of their target, keeping the requested edge
+    // order inside each group. A range is then scattered by a single thread
+    // straight into its own slice of next
+    int ranges = threads * RANGES_PER_THREAD;
+    vector<int> bounds = graph.partition(ranges);
+    vector<int> range_of(n);
+#pragma omp parallel for
+    for (int r = 0; r < ranges; r++)
+    {
+        for (int v = bounds[r]; v < bounds[r + 1]; v++)
+            range_of[v] = r;
+    }
+
+    // Stable counting sort, chunk t of the edges counts and moves its own edges
+    vector<vector<int64_t>> counts(threads, vector<int64_t>(ranges + 1, 0));
+#pragma omp parallel for num_threads(threads) schedule(static, 1)
+    for (int t = 0; t < threads; t++)
+    {
+        for (int64_t e = t * m / threads; e < (t + 1) * m / threads; e++)
+            counts[t][range_of[coo.edges[e].target]]++;
+    }
+    vector<int64_t> edge_offsets(ranges + 1, 0);
+    int64_t position = 0;
+    for (int r = 0; r < ranges; r++)
+    {
+        edge_offsets[r] = position;
+        for (int t = 0; t < threads; t++)
+        {
+            int64_t count = counts[t][r];
+            counts[t][r] = position;
+            position += count;
+        }
+    }
+    edge_offsets[ranges] = position;
+
+    vector<Edge> edges(m);
+#pragma omp parallel for num_threads(threads) schedule(static, 1)
+    for (int t = 0; t < threads; t++)
+    {
+        for (int64_t e = t * m / threads; e < (t + 1) * m / threads; e++)
+            edges[counts[t][range_of[coo.edges[e].target]]++] = coo.edges[e];
+    }
+    coo.edges.clear();
+    coo.edges.shrink_to_fit();
+
+    // A range cannot split a node, so one holding an in-hub can carry far more
+    // than the average edge load. Such a range is cut into pieces of about the
+    // average load, each piece sums into its own partial slice sized to the
+    // range, and the slices are merged once all pieces are done
+    struct Piece
+    {
+        int range;
+        int64_t begin;
+        int64_t end;
+        // Offset of the partial slice, or -1 to scatter straight into next
+        int64_t slot;
+    };
+    struct SplitRange
+    {
+        int range;
+        int pieces;
+        int64_t slot;
+    };
+    int64_t average = max<int64_t>(1, m / ranges);
+    vector<Piece> pieces;
+    vector<SplitRange> split;
+    int64_t partial_size = 0;
+    for (int r = 0; r < ranges; r++)
+    {
+        int64_t load = edge_offsets[r + 1] - edge_offsets[r];
+        if (load <= average)
+        {
+            pieces.push_back({r, edge_offsets[r], edge_offsets[r + 1], -1});
+            continue;
+        }
+        int count = (load + average - 1) / average;
+        int size = bounds[r + 1] - bounds[r];
+        split.push_back({r, count, partial_size});
+        for (int p = 0; p < count; p++)
+            pieces.push_back({r, edge_offsets[r] + load * p / count, edge_offsets[r] + load * (p + 1) / count, partial_size + (int64_t)p * size});
+        partial_size += (int64_t)count * size;
+    }
+    int n_pieces = pieces.size();
+    int n_split = split.size();
+    vector<double> partial(partial_size);
+
+    vector<double> contrib(n);
+    vector<double> next(n);
+
+    for (int it = 0; it < this->options.max_iterations; it++)
+    {
+        double dangling = compute_contributions(graph, this->ranks, contrib);
+        double base = (1.0 - d) / n + d * dangling / n;
+
+        double residual = 0.0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : residual)
+        for (int i = 0; i < n_pieces; i++)
+        {
+            const Piece &piece = pieces[i];
+            int lo = bounds[piece.range];
+            int hi = bounds[piece.range + 1];
+            if (piece.slot >= 0)
+            {
+                double *sums = partial.data() + piece.slot - lo;
+                fill(sums + lo, sums + hi, 0.0);
+                for (int64_t e = piece.begin; e < piece.end; e++)
+                    sums[edges[e].target] += contrib[edges[e].source];
+                continue;
+            }
+
+            fill(next.begin() + lo, next.begin() + hi, 0.0);
+            for (int64_t e = piece.begin; e < piece.end; e++)
+                next[edges[e].target] += contrib[edges[e].source];
+            for (int v = lo; v < hi; v++)
+            {
+                next[v] = base + d * next[v];
+                residual += fabs(next[v] - this->ranks[v]);
+            }
+        }
+
+        // Merge the partial slices of the ranges that were cut into pieces
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : residual)
+        for (int i = 0; i < n_split; i++)
+        {
+            int lo = bounds[split[i].range];
+            int size = bounds[split[i].range + 1] - lo;
+            for (int k = 0; k < size; k++)
+            {
+                double sum = 0.0;
+                for (int p = 0; p < split[i].pieces; p++)
+                    sum += partial[split[i].slot + (int64_t)p * size + k];
+                next[lo + k] = base + d * sum;
+                residual += fabs(next[lo + k] - this->ranks[lo + k]);
+            }
+        }
+
+        this->ranks.swap(next);
+        this->stats.iterations++;
+        this->stats.residual = residual;
+        this->stats.edges_processed += m;
+
+        if (residual < this->options.tolerance)
+        {
+            this->stats.converged = true;
+            break;
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#include "edge_file.h"
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+bool write_edge_file(const string &path, const CsrGraph &graph)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::cout << "ERROR::EDGE_FILE::OPEN_FAILED\n"
+                  << path << std::endl;
+        return false;
+    }
+
+    EdgeFileHeader header = {EDGE_FILE_MAGIC, graph.num_nodes, graph.num_edges()};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    vector<Edge> chunk;
+    for (int u = 0; u < graph.num_nodes && ok; u++)
+    {
+        for (int64_t e = graph.out_offsets[u]; e < graph.out_offsets[u + 1]; e++)
+        {
+            chunk.push_back({u, graph.out_targets[e]});
+        }
+        if (chunk.size() >= (1 << 20) || u == graph.num_nodes - 1)
+        {
+            ok = fwrite(chunk.data(), sizeof(Edge), chunk.size(), file) == chunk.size();
+            chunk.clear();
+        }
+    }
+
+    ok &= fclose(file) == 0;
+    if (!ok)
+    {
+        std::cout << "ERROR::EDGE_FILE::WRITE_FAILED\n"
+                  << path << std::endl;
+    }
+    return ok;
+}
+
+EdgeStream::EdgeStream(size_t chunk_edges, int num_buffers) : header{0, 0, 0},
+                                                              chunk_edges{chunk_edges},
+                                                              num_buffers{max(num_buffers, 2)},
+                                                              file{nullptr}
+{
+}
+
+EdgeStream::~EdgeStream()
+{
+    close();
+}
+
+bool EdgeStream::open(const string &path)
+{
+    close();
+    this->file = fopen(path.c_str(), "rb");
+    if (this->file == nullptr)
+    {
+        std::cout << "ERROR::EDGE_FILE::OPEN_FAILED\n"
+                  << path << std::endl;
+        return false;
+    }
+
+    if (fread(&this->header, sizeof(this->header), 1, this->file) != 1 || this->header.magic != EDGE_FILE_MAGIC)
+    {
+        std::cout << "ERROR::EDGE_FILE::BAD_HEADER\n"
+                  << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void EdgeStream::close()
+{
+    if (this->file != nullptr)
+    {
+        fclose(this->file);
+        this->file = nullptr;
+    }
+}
+
+bool EdgeStream::scan(const function<void(const Edge *edges, size_t count)> &visit)
+{
+    if (this->file == nullptr || fseek(this->file, sizeof(EdgeFileHeader), SEEK_SET) != 0)
+        return false;
+
+    if (this->buffers.size() != this->num_buffers || this->buffers[0].size() != this->chunk_edges)
+        this->buffers.assign(this->num_buffers, vector<Edge>(this->chunk_edges));
+    vector<vector<Edge>> &buffers = this->buffers;
+    vector<size_t> counts(this->num_buffers, 0);
+    queue<int> free_buffers;
+    queue<int> ready_buffers;
+    for (int i = 0; i < this->num_buffers; i++)
+        free_buffers.push(i);
+
+    mutex lock;
+    condition_variable changed;
+    bool done = false;
+    bool failed = false;
+
+    // The I/O thread fills free buffers in file order and hands them over
+    auto read_ahead = [&]()
+    {
+        int64_t remaining = this->header.num_edges;
+        while (remaining > 0)
+        {
+            int b;
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&]() { return !free_buffers.empty(); });
+                b = free_buffers.front();
+                free_buffers.pop();
+            }
+
+            size_t wanted = min<int64_t>(remaining, this->chunk_edges);
+            size_t got = fread(buffers[b].data(), sizeof(Edge), wanted, this->file);
+            remaining -= got;
+
+            {
+                lock_guard<mutex> guard(lock);
+                counts[b] = got;
+                ready_buffers.push(b);
+                failed = got < wanted;
+            }
+            changed.notify_all();
+            if (got < wanted)
+                break;
+        }
+
+        {
+            lock_guard<mutex> guard(lock);
+            done = true;
+        }
+        changed.notify_all();
+    };
+    thread reader(read_ahead);
+
+    while (true)
+    {
+        int b;
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&]() { return !ready_buffers.empty() || done; });
+            if (ready_buffers.empty())
+                break;
+            b = ready_buffers.front();
+            ready_buffers.pop();
+        }
+
+        if (counts[b] > 0)
+            visit(buffers[b].data(), counts[b]);
+
+        {
+            lock_guard<mutex> guard(lock);
+            free_buffers.push(b);
+        }
+        changed.notify_all();
+    }
+
+    reader.join();
+    if (failed)
+    {
+        std::cout << "ERROR::EDGE_FILE::TRUNCATED" << std::endl;
+    }
+    return !failed;
+}
@@ -0,0 +1,66 @@
+#ifndef EDGE_FILE_H
+#define EDGE_FILE_H
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+// Binary edge file: a header followed by num_edges (source, target) pairs
+// Edges can be in any order, they are only ever read front to back
+struct EdgeFileHeader
+{
+    uint32_t magic;
+    int32_t num_nodes;
+    int64_t num_edges;
+};
+
+struct Edge
+{
+    int32_t source;
+    int32_t target;
+};
+
+// Edge observed at a point in time, in caller-defined units
+struct TimedEdge
+{
+    int32_t source;
+    int32_t target;
+    int64_t time;
+};
+
+const uint32_t EDGE_FILE_MAGIC = 0x45524B50; // "PKRE"
+
+// Dump every arc of the graph in source order
+bool write_edge_file(const string &path, const CsrGraph &graph);
+
+// Sequential reader for edge files that are too large to load
+// While one chunk is being processed the next ones are read on an I/O thread
+class EdgeStream
+{
+public:
+    EdgeFileHeader header;
+    // Edges per read, 4M edges = 32MB by default
+    size_t chunk_edges;
+    // Chunks kept in flight, one is processed while the others are filled
+    int num_buffers;
+
+    EdgeStream(size_t chunk_edges = 1 << 22, int num_buffers = 3);
+    ~EdgeStream();
+
+    bool open(const string &path);
+    void close();
+
+    // Call visit on every chunk of edges, in file order
+    // Returns false if the file could not be read to the end
+    bool scan(const function<void(const Edge *edges, size_t count)> &visit);
+
+private:
+    FILE *file;
+    // Reused across scans so each pass does not pay for fresh allocations
+    vector<vector<Edge>> buffers;
+};
+#endif
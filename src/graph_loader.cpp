@@ -0,0 +1,357 @@
+#include "graph_loader.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef PAGERANK_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+static bool ends_with(const string &text, const string &suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+ByteStream::ByteStream(size_t block_size, int num_blocks) : block_size{block_size},
+                                                            num_blocks{max(num_blocks, 2)},
+                                                            file{nullptr}
+{
+}
+
+ByteStream::~ByteStream()
+{
+    close();
+}
+
+bool ByteStream::open(const string &path)
+{
+    close();
+#ifdef PAGERANK_ZLIB
+    // gzopen reads uncompressed files as they are
+    gzFile gz = gzopen(path.c_str(), "rb");
+    if (gz != nullptr)
+        gzbuffer(gz, 1 << 17);
+    this->file = gz;
+#else
+    if (ends_with(path, ".gz"))
+    {
+        std::cout << "ERROR::BYTE_STREAM::NO_ZLIB\n"
+                  << path << std::endl;
+        return false;
+    }
+    this->file = fopen(path.c_str(), "rb");
+#endif
+    if (this->file == nullptr)
+    {
+        std::cout << "ERROR::BYTE_STREAM::OPEN_FAILED\n"
+                  << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ByteStream::close()
+{
+    if (this->file != nullptr)
+    {
+#ifdef PAGERANK_ZLIB
+        gzclose((gzFile)this->file);
+#else
+        fclose((FILE *)this->file);
+#endif
+        this->file = nullptr;
+    }
+}
+
+bool ByteStream::scan(const function<void(const char *data, size_t size)> &visit)
+{
+    if (this->file == nullptr)
+        return false;
+
+    if (this->blocks.size() != this->num_blocks || this->blocks[0].size() != this->block_size)
+        this->blocks.assign(this->num_blocks, vector<char>(this->block_size));
+    vector<vector<char>> &blocks = this->blocks;
+    vector<size_t> sizes(this->num_blocks, 0);
+    queue<int> free_blocks;
+    queue<int> ready_blocks;
+    for (int i = 0; i < this->num_blocks; i++)
+        free_blocks.push(i);
+
+    mutex lock;
+    condition_variable changed;
+    bool done = false;
+    bool failed = false;
+    bool truncated = false;
+
+    // The reader thread reads (and inflates) into free blocks in file order
+    auto read_ahead = [&]()
+    {
+        while (true)
+        {
+            int b;
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&]() { return !free_blocks.empty(); });
+                b = free_blocks.front();
+                free_blocks.pop();
+            }
+
+#ifdef PAGERANK_ZLIB
+            int got = gzread((gzFile)this->file, blocks[b].data(), this->block_size);
+            // A stream cut short reads as end of file, gzerror tells it apart
+            int errnum = Z_OK;
+            gzerror((gzFile)this->file, &errnum);
+            bool cut = errnum == Z_BUF_ERROR || errnum == Z_DATA_ERROR;
+            bool error = got < 0 || cut;
+#else
+            bool cut = false;
+            size_t got = fread(blocks[b].data(), 1, this->block_size, (FILE *)this->file);
+            bool error = ferror((FILE *)this->file) != 0;
+#endif
+
+            {
+                lock_guard<mutex> guard(lock);
+                sizes[b] = error ? 0 : got;
+                ready_blocks.push(b);
+                failed = error;
+                truncated = cut;
+            }
+            changed.notify_all();
+            if (error || got == 0)
+                break;
+        }
+
+        {
+            lock_guard<mutex> guard(lock);
+            done = true;
+        }
+        changed.notify_all();
+    };
+    thread reader(read_ahead);
+
+    while (true)
+    {
+        int b;
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&]() { return !ready_blocks.empty() || done; });
+            if (ready_blocks.empty())
+                break;
+            b = ready_blocks.front();
+            ready_blocks.pop();
+        }
+
+        if (sizes[b] > 0)
+            visit(blocks[b].data(), sizes[b]);
+
+        {
+            lock_guard<mutex> guard(lock);
+            free_blocks.push(b);
+        }
+        changed.notify_all();
+    }
+
+    reader.join();
+    if (truncated)
+    {
+        std::cout << "ERROR::GRAPH_LOADER::TRUNCATED_INPUT\n"
+                  << "compressed stream ends early or is corrupt" << std::endl;
+    }
+    else if (failed)
+    {
+        std::cout << "ERROR::BYTE_STREAM::READ_FAILED" << std::endl;
+    }
+    return !failed;
+}
+
+// Split the stream into lines, a line cut by a block boundary is carried over
+static bool scan_lines(ByteStream &stream, const function<void(const char *begin, const char *end)> &line)
+{
+    string carry;
+    auto split = [&](const char *data, size_t size)
+    {
+        const char *end = data + size;
+        const char *start = data;
+        if (!carry.empty())
+        {
+            const char *newline = find(data, end, '\n');
+            carry.append(data, newline);
+            if (newline == end)
+                return;
+            line(carry.data(), carry.data() + carry.size());
+            carry.clear();
+            start = newline + 1;
+        }
+
+        while (start < end)
+        {
+            const char *newline = find(start, end, '\n');
+            if (newline == end)
+            {
+                carry.assign(start, end);
+                break;
+            }
+            line(start, newline);
+            start = newline + 1;
+        }
+    };
+    if (!stream.scan(split))
+        return false;
+    if (!carry.empty())
+        line(carry.data(), carry.data() + carry.size());
+    return true;
+}
+
+static const char *skip_spaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+// Read the next integer of the line, false if there is none
+static bool next_int(const char *&p, const char *end, int64_t &value)
+{
+    p = skip_spaces(p, end);
+    auto [next, error] = from_chars(p, end, value);
+    if (error != errc())
+        return false;
+    p = next;
+    return true;
+}
+
+// Whitespace separated words of a line, lowercased
+static vector<string> words(const char *begin, const char *end)
+{
+    vector<string> result;
+    const char *p = skip_spaces(begin, end);
+    while (p < end)
+    {
+        const char *q = p;
+        while (q < end && !isspace((unsigned char)*q))
+            q++;
+        result.emplace_back(p, q);
+        for (char &c : result.back())
+            c = tolower((unsigned char)c);
+        p = skip_spaces(q, end);
+    }
+    return result;
+}
+
+static bool read_edge_list(ByteStream &stream, vector<pair<int, int>> &edges, int &num_nodes)
+{
+    bool ok = true;
+    int64_t max_node = -1;
+    auto parse = [&](const char *begin, const char *end)
+    {
+        const char *p = skip_spaces(begin, end);
+        if (!ok || p == end || *p == '#' || *p == '%')
+            return;
+        int64_t u, v;
+        ok = next_int(p, end, u) && next_int(p, end, v) && u >= 0 && v >= 0 && u < INT32_MAX && v < INT32_MAX;
+        if (ok)
+        {
+            edges.push_back({(int)u, (int)v});
+            max_node = max(max_node, max(u, v));
+        }
+    };
+    if (!scan_lines(stream, parse) || !ok)
+        return false;
+    num_nodes = max_node + 1;
+    return true;
+}
+
+static bool read_matrix_market(ByteStream &stream, vector<pair<int, int>> &edges, int &num_nodes)
+{
+    bool ok = true;
+    bool banner = false;
+    bool symmetric = false;
+    bool sized = false;
+    int64_t rows = 0, cols = 0, entries = 0, seen = 0;
+
+    auto parse = [&](const char *begin, const char *end)
+    {
+        if (!ok)
+            return;
+        const char *p = skip_spaces(begin, end);
+        if (!banner)
+        {
+            // %%MatrixMarket matrix coordinate <field> <symmetry>
+            vector<string> header = words(begin, end);
+            ok = header.size() >= 5 && header[0] == "%%matrixmarket" && header[1] == "matrix" && header[2] == "coordinate";
+            symmetric = ok && header[4] != "general";
+            banner = true;
+            return;
+        }
+        if (p == end || *p == '%')
+            return;
+
+        if (!sized)
+        {
+            ok = next_int(p, end, rows) && next_int(p, end, cols) && next_int(p, end, entries) &&
+                 rows >= 0 && cols >= 0 && entries >= 0 && max(rows, cols) < INT32_MAX;
+            sized = true;
+            if (ok)
+                edges.reserve(symmetric ? 2 * entries : entries);
+            return;
+        }
+
+        // Values after the coordinates are ignored, only the pattern is used
+        int64_t i, j;
+        ok = next_int(p, end, i) && next_int(p, end, j) && i >= 1 && i <= rows && j >= 1 && j <= cols && seen < entries;
+        if (!ok)
+            return;
+        edges.push_back({(int)(i - 1), (int)(j - 1)});
+        if (symmetric && i != j)
+            edges.push_back({(int)(j - 1), (int)(i - 1)});
+        seen++;
+    };
+
+    if (!scan_lines(stream, parse) || !ok || !sized || seen != entries)
+        return false;
+    num_nodes = max(rows, cols);
+    return true;
+}
+
+bool load_graph(const string &path, CsrGraph &csr)
+{
+    string name = ends_with(path, ".gz") ? path.substr(0, path.size() - 3) : path;
+    if (ends_with(name, ".bin"))
+    {
+        // from_edge_file reads blocks at file offsets, so it cannot inflate
+        if (name != path)
+        {
+            std::cout << "ERROR::GRAPH_LOADER::COMPRESSED_BINARY\n"
+                      << path << std::endl;
+            return false;
+        }
+        return CsrGraph::from_edge_file(path, csr);
+    }
+
+    ByteStream stream;
+    if (!stream.open(path))
+        return false;
+
+    vector<pair<int, int>> edges;
+    int num_nodes = 0;
+    bool ok = ends_with(name, ".mtx") ? read_matrix_market(stream, edges, num_nodes) : read_edge_list(stream, edges, num_nodes);
+    if (!ok)
+    {
+        std::cout << "ERROR::GRAPH_LOADER::BAD_FILE\n"
+                  << path << std::endl;
+        return false;
+    }
+
+    return CsrGraph::from_unsorted_edges(num_nodes, move(edges), csr);
+}
@@ -0,0 +1,46 @@
+#ifndef GRAPH_LOADER_H
+#define GRAPH_LOADER_H
+#include <functional>
+#include <string>
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+// Sequential byte reader for text graph files
+// Files ending in .gz are inflated on the fly (when built with zlib). Reading or
+// inflating runs on its own thread, which fills a bounded set of blocks while
+// the caller parses the previous ones
+class ByteStream
+{
+public:
+    // Bytes per block, 4MB by default
+    size_t block_size;
+    // Blocks in flight, one is parsed while the others are filled
+    int num_blocks;
+
+    ByteStream(size_t block_size = 1 << 22, int num_blocks = 4);
+    ~ByteStream();
+
+    bool open(const string &path);
+    void close();
+
+    // Call visit on every block of bytes, in file order
+    // Returns false if the file could not be read to the end
+    bool scan(const function<void(const char *data, size_t size)> &visit);
+
+private:
+    // gzFile when built with zlib, FILE * otherwise
+    void *file;
+    vector<vector<char>> blocks;
+};
+
+// Load a graph, the format is picked by extension once a .gz suffix is removed:
+//     .mtx  Matrix Market coordinate file, 1-based, symmetric ones get both arcs
+//     .bin  binary edge file (see edge_file.h), .bin.gz is rejected
+//     other whitespace separated "source target" lines, 0-based, lines
+//           starting with # or % are comments (SNAP style)
+// Text formats go through CsrGraph::from_unsorted_edges, so self-loops and
+// repeated arcs are dropped
+bool load_graph(const string &path, CsrGraph &csr);
+#endif
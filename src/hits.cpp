@@ -0,0 +1,66 @@
+#include "hits.h"
+#include "spmv.h"
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+Hits::Hits(HitsOptions options) : options{options}
+{
+}
+
+// Scale the scores to sum to 1 and return the L1 change against previous
+static double normalize(vector<double> &scores, const vector<double> &previous)
+{
+    int n = scores.size();
+    double total = accumulate(scores.begin(), scores.end(), 0.0);
+    double change = 0.0;
+
+#pragma omp parallel for reduction(+ : change)
+    for (int v = 0; v < n; v++)
+    {
+        // A graph without edges leaves every score at zero, keep them uniform
+        scores[v] = total > 0.0 ? scores[v] / total : 1.0 / n;
+        change += fabs(scores[v] - previous[v]);
+    }
+    return change;
+}
+
+void Hits::run(const CsrGraph &graph)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = this->options.tolerance;
+    int n = graph.num_nodes;
+    this->authorities.assign(n, n > 0 ? 1.0 / n : 0.0);
+    this->hubs.assign(n, n > 0 ? 1.0 / n : 0.0);
+    if (n == 0)
+    {
+        this->stats.converged = true;
+        return;
+    }
+
+    vector<double> next(n);
+    for (int it = 0; it < this->options.max_iterations; it++)
+    {
+        // Authority update pulls the hub scores over in-edges
+        spmv<PlusTimes<double>, UnitWeight, EdgeDirection::IN>(graph, this->hubs, next);
+        double residual = normalize(next, this->authorities);
+        this->authorities.swap(next);
+
+        // Hub update pulls the new authority scores over out-edges
+        spmv<PlusTimes<double>, UnitWeight, EdgeDirection::OUT>(graph, this->authorities, next);
+        residual += normalize(next, this->hubs);
+        this->hubs.swap(next);
+
+        this->stats.iterations++;
+        this->stats.residual = residual;
+        this->stats.edges_processed += 2 * graph.num_edges();
+
+        if (residual < this->options.tolerance)
+        {
+            this->stats.converged = true;
+            break;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef HITS_H
+#define HITS_H
+#include <vector>
+#include "csr_graph.h"
+#include "pagerank.h"
+
+using namespace std;
+
+struct HitsOptions
+{
+    // Stop once the L1 change of both score vectors drops below this
+    double tolerance = 1e-8;
+    int max_iterations = 100;
+};
+
+// Kleinberg's hubs and authorities
+// A good authority is linked by good hubs and a good hub links to good authorities
+class Hits
+{
+public:
+    HitsOptions options;
+    // Same convergence reporting as the PageRank engine
+    PageRankStats stats;
+    // Both vectors sum to 1
+    vector<double> authorities;
+    vector<double> hubs;
+
+    Hits(HitsOptions options);
+
+    void run(const CsrGraph &graph);
+};
+#endif
@@ -134,20 +134,22 @@ void init_graph()
     // Ensure every node is reachable from any other node
     for (int i = 0; i < graph.node_list.size(); i++)
     {
+        // Iterative DFS, a recursive one overflows the stack on deep graphs
         std::unordered_set<int> visited;
-        std::function<void(int)> dfs = [&](int node)
+        std::vector<int> stack = {i};
+        visited.insert(i);
+        while (!stack.empty())
         {
-            visited.insert(node);
+            int node = stack.back();
+            stack.pop_back();
             for (int neighbor : graph.adj_list[node])
             {
-                if (visited.find(neighbor) == visited.end())
+                if (visited.insert(neighbor).second)
                 {
-                    dfs(neighbor);
+                    stack.push_back(neighbor);
                 }
             }
-        };
-
-        dfs(i);
+        }
 
         for (int j = 0; j < graph.node_list.size(); j++)
         {
@@ -0,0 +1,492 @@
+#include "pagerank.h"
+#include "edge_file.h"
+#include "scc.h"
+#include "spmv.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+using namespace std;
+
+// Components mode falls back to power iteration when one strongly connected
+// component holds more than this fraction of the nodes
+const double GIANT_COMPONENT_FRACTION = 0.5;
+
+PageRank::PageRank(PageRankOptions options) : options{options}
+{
+}
+
+const vector<double> &PageRank::run(const CsrGraph &graph)
+{
+    return run(graph, vector<double>());
+}
+
+const vector<double> &PageRank::run(const CsrGraph &graph, const vector<double> &initial)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = effective_tolerance();
+    double total = accumulate(initial.begin(), initial.end(), 0.0);
+    if (initial.size() == graph.num_nodes && total > 0.0)
+    {
+        this->ranks.resize(graph.num_nodes);
+        for (int v = 0; v < graph.num_nodes; v++)
+            this->ranks[v] = initial[v] / total;
+    }
+    else
+    {
+        this->ranks.assign(graph.num_nodes, graph.num_nodes > 0 ? 1.0 / graph.num_nodes : 0.0);
+    }
+
+    if (graph.num_nodes == 0)
+    {
+        this->stats.converged = true;
+        return this->ranks;
+    }
+
+    switch (this->options.mode)
+    {
+    case PageRankMode::POWER:
+        if (this->options.single_precision)
+            float_power_iteration(graph);
+        else if (this->options.kernel == PageRankKernel::EDGE_CENTRIC)
+            edge_centric_iteration(graph);
+        else
+            power_iteration(graph);
+        break;
+    case PageRankMode::COMPONENTS:
+        component_iteration(graph);
+        break;
+    case PageRankMode::BLOCK:
+        block_iteration(graph);
+        break;
+    case PageRankMode::ASYNC:
+        async_iteration(graph);
+        break;
+    }
+
+    return this->ranks;
+}
+
+double PageRank::effective_tolerance() const
+{
+    if (this->options.single_precision && this->options.mode == PageRankMode::POWER)
+        return max(this->options.tolerance, 4.0 * numeric_limits<float>::epsilon());
+    return this->options.tolerance;
+}
+
+bool PageRank::run_out_of_core(const string &edge_file)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = this->options.tolerance;
+    this->ranks.clear();
+
+    EdgeStream stream;
+    if (!stream.open(edge_file))
+        return false;
+
+    int n = stream.header.num_nodes;
+    double d = this->options.damping;
+    this->ranks.assign(n, n > 0 ? 1.0 / n : 0.0);
+    if (n == 0)
+    {
+        this->stats.converged = true;
+        return true;
+    }
+
+    // First pass counts out-degrees and checks every id, so the scatter
+    // passes can index with them unchecked
+    vector<int> degree(n, 0);
+    bool valid = true;
+    auto count_degrees = [&](const Edge *edges, size_t count)
+    {
+        for (size_t i = 0; i < count && valid; i++)
+        {
+            if (edges[i].source < 0 || edges[i].source >= n || edges[i].target < 0 || edges[i].target >= n)
+                valid = false;
+            else
+                degree[edges[i].source]++;
+        }
+    };
+    if (!stream.scan(count_degrees))
+        return false;
+    if (!valid)
+    {
+        std::cout << "ERROR::PAGERANK::EDGE_OUT_OF_RANGE\n"
+                  << edge_file << std::endl;
+        return false;
+    }
+
+    vector<double> contrib(n);
+    vector<double> next(n);
+    for (int it = 0; it < this->options.max_iterations; it++)
+    {
+        double dangling = 0.0;
+#pragma omp parallel for reduction(+ : dangling)
+        for (int u = 0; u < n; u++)
+        {
+            if (degree[u] == 0)
+                dangling += this->ranks[u];
+            contrib[u] = degree[u] == 0 ? 0.0 : this->ranks[u] / degree[u];
+        }
+
+        // Edges come in any order, so contributions are scattered to their target
+        fill(next.begin(), next.end(), 0.0);
+        auto scatter = [&](const Edge *edges, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                next[edges[i].target] += contrib[edges[i].source];
+        };
+        if (!stream.scan(scatter))
+            return false;
+
+        double base = (1.0 - d) / n + d * dangling / n;
+        double residual = 0.0;
+#pragma omp parallel for reduction(+ : residual)
+        for (int v = 0; v < n; v++)
+        {
+            next[v] = base + d * next[v];
+            residual += fabs(next[v] - this->ranks[v]);
+        }
+
+        this->ranks.swap(next);
+        this->stats.iterations++;
+        this->stats.residual = residual;
+        this->stats.edges_processed += stream.header.num_edges;
+
+        if (residual < this->options.tolerance)
+        {
+            this->stats.converged = true;
+            break;
+        }
+    }
+    return true;
+}
+
+double compute_contributions(const CsrGraph &graph, const vector<double> &ranks, vector<double> &contrib)
+{
+    double dangling = 0.0;
+#pragma omp parallel for reduction(+ : dangling)
+    for (int u = 0; u < graph.num_nodes; u++)
+    {
+        int degree = graph.out_degree(u);
+        if (degree == 0)
+        {
+            dangling += ranks[u];
+            contrib[u] = 0.0;
+        }
+        else
+        {
+            contrib[u] = ranks[u] / degree;
+        }
+    }
+    return dangling;
+}
+
+void PageRank::power_iteration(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    double d = this->options.damping;
+    vector<double> contrib(n);
+    vector<double> next(n);
+
+    // The iterates before each of the three iterations leading to an
+    // extrapolation point, in rotating buffers, only kept when extrapolating
+    int interval = this->options.extrapolation_interval;
+    bool extrapolating = interval > 0;
+    vector<vector<double>> history(extrapolating ? 3 : 0);
+    int stored = 0;
+    int last_extrapolated = -1;
+
+    // Plain power iteration shrinks the residual at a rate that creeps up to
+    // |lambda_2| as the faster modes die out. The largest ratio between two
+    // residuals not disturbed by an extrapolation estimates that rate
+    double previous_residual = 0.0;
+    double slowest_rate = 0.0;
+    // Residual and iteration count at the first extrapolation
+    double plain_residual = 0.0;
+    int plain_iterations = 0;
+
+    for (int it = 0; it < this->options.max_iterations; it++)
+    {
+        if (extrapolating && (interval - (this->stats.iterations + 1) % interval) % interval <= 2)
+            history[stored++ % 3] = this->ranks;
+
+        double dangling = compute_contributions(graph, this->ranks, contrib);
+        double base = (1.0 - d) / n + d * dangling / n;
+        auto update = [&](int v, double incoming)
+        {
+            next[v] = base + d * incoming;
+            return fabs(next[v] - this->ranks[v]);
+        };
+        double residual = spmv<PlusTimes<double>>(graph, contrib.data(), update);
+
+        this->ranks.swap(next);
+        this->stats.iterations++;
+        this->stats.residual = residual;
+        this->stats.edges_processed += graph.num_edges();
+        if (this->stats.iterations - last_extrapolated > 2 && previous_residual > 0.0 && residual < previous_residual)
+            slowest_rate = max(slowest_rate, residual / previous_residual);
+        previous_residual = residual;
+
+        if (residual < this->options.tolerance)
+        {
+            this->stats.converged = true;
+            break;
+        }
+
+        if (extrapolating && stored >= 3 && this->stats.iterations % interval == 0)
+        {
+            if (extrapolate(history[(stored - 3) % 3], history[(stored - 2) % 3], history[(stored - 1) % 3]))
+            {
+                if (this->stats.extrapolations == 0)
+                {
+                    plain_iterations = this->stats.iterations;
+                    plain_residual = residual;
+                }
+                this->stats.extrapolations++;
+                last_extrapolated = this->stats.iterations;
+            }
+            stored = 0;
+        }
+    }
+
+    // Iterations plain power iteration would have needed from the first
+    // extrapolation on, decaying at the slowest rate seen
+    if (this->stats.converged && this->stats.extrapolations > 0 && slowest_rate > 0.0)
+    {
+        int expected = plain_iterations + (int)ceil(log(this->options.tolerance / plain_residual) / log(slowest_rate));
+        this->stats.iterations_saved = max(0, expected - this->stats.iterations);
+    }
+}
+
+// Quadratic extrapolation: assume the current ranks are a combination of the
+// principal eigenvector and two other eigenvectors, and cancel the latter
+// x1, x2, x3 are the three iterates preceding the current ranks, oldest first
+bool PageRank::extrapolate(const vector<double> &x1, const vector<double> &x2, const vector<double> &x3)
+{
+    int n = this->ranks.size();
+    vector<double> &x4 = this->ranks;
+
+    // Solve the 2x2 least squares problem [y2 y3] g = -y4 with yk = xk - x1
+    double a = 0.0, b = 0.0, c = 0.0, p = 0.0, q = 0.0;
+#pragma omp parallel for reduction(+ : a, b, c, p, q)
+    for (int i = 0; i < n; i++)
+    {
+        double y2 = x2[i] - x1[i];
+        double y3 = x3[i] - x1[i];
+        double y4 = x4[i] - x1[i];
+        a += y2 * y2;
+        b += y2 * y3;
+        c += y3 * y3;
+        p += y2 * y4;
+        q += y3 * y4;
+    }
+
+    double det = a * c - b * b;
+    if (fabs(det) <= 1e-12 * a * c)
+        return false;
+
+    double g1 = (-p * c + q * b) / det;
+    double g2 = (-q * a + p * b) / det;
+    double g3 = 1.0;
+    double beta0 = g1 + g2 + g3;
+    double beta1 = g2 + g3;
+    double beta2 = g3;
+
+#pragma omp parallel for
+    for (int i = 0; i < n; i++)
+    {
+        x4[i] = fabs(beta0 * x2[i] + beta1 * x3[i] + beta2 * x4[i]);
+    }
+
+    double total = accumulate(x4.begin(), x4.end(), 0.0);
+    if (total > 0.0)
+    {
+        for (double &r : x4)
+            r /= total;
+    }
+    return true;
+}
+
+// With dangling rank spread uniformly, PageRank is proportional to the solution
+// of y = d * P^T y + (1 - d) / n, where dangling nodes simply leak their rank.
+// That system has no global term, so it can be solved one component at a time
+// in topological order and normalized at the end
+void PageRank::component_iteration(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    double d = this->options.damping;
+    double teleport = (1.0 - d) / n;
+    SccDecomposition scc = strongly_connected_components(graph);
+    this->stats.components = scc.num_components;
+
+    // Sweeps inside a component converge at about the damping factor, slower
+    // than power iteration on the whole graph, which converges at |lambda_2|.
+    // The decomposition only pays off when no component dominates the graph
+    int largest = 0;
+    for (int c = 0; c < scc.num_components; c++)
+        largest = max(largest, scc.offsets[c + 1] - scc.offsets[c]);
+    if (largest > n * GIANT_COMPONENT_FRACTION)
+    {
+        power_iteration(graph);
+        return;
+    }
+    this->stats.converged = true;
+
+    // contrib[u] is only read once u's component is final, except inside the
+    // component being solved
+    vector<double> contrib(n, 0.0);
+    vector<double> external(n, 0.0);
+
+    for (int c = 0; c < scc.num_components; c++)
+    {
+        const int *nodes = scc.nodes.data() + scc.offsets[c];
+        int size = scc.offsets[c + 1] - scc.offsets[c];
+
+        // Split each node's in-edges into the fixed upstream part and the
+        // part coming from inside the component
+        int64_t internal_edges = 0;
+        for (int i = 0; i < size; i++)
+        {
+            int v = nodes[i];
+            double sum = 0.0;
+            for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; e++)
+            {
+                int u = graph.in_sources[e];
+                if (scc.component[u] != c)
+                    sum += contrib[u];
+                else
+                    internal_edges++;
+            }
+            external[v] = teleport + d * sum;
+            this->ranks[v] = external[v];
+            this->stats.edges_processed += graph.in_degree(v);
+        }
+
+        // Gauss-Seidel sweeps inside the component: each node reads the
+        // contributions already updated in this sweep. Trivial components
+        // without a self-loop are already exact
+        int iterations = internal_edges == 0 ? 0 : this->options.max_iterations;
+        double tolerance = this->options.tolerance * size / n;
+        bool converged = internal_edges == 0;
+        for (int i = 0; i < size; i++)
+        {
+            int u = nodes[i];
+            contrib[u] = graph.out_degree(u) == 0 ? 0.0 : this->ranks[u] / graph.out_degree(u);
+        }
+        for (int it = 0; it < iterations; it++)
+        {
+            double residual = 0.0;
+            for (int i = 0; i < size; i++)
+            {
+                int v = nodes[i];
+                double sum = 0.0;
+                for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; e++)
+                {
+                    int u = graph.in_sources[e];
+                    if (scc.component[u] == c)
+                        sum += contrib[u];
+                }
+                double value = external[v] + d * sum;
+                residual += fabs(value - this->ranks[v]);
+                this->ranks[v] = value;
+                contrib[v] = graph.out_degree(v) == 0 ? 0.0 : value / graph.out_degree(v);
+            }
+            this->stats.iterations = max(this->stats.iterations, it + 1);
+            this->stats.edges_processed += internal_edges;
+
+            if (residual < tolerance)
+            {
+                converged = true;
+                break;
+            }
+        }
+        this->stats.converged &= converged;
+    }
+
+    double total = accumulate(this->ranks.begin(), this->ranks.end(), 0.0);
+    for (double &r : this->ranks)
+        r /= total;
+}
+
+// The k + 1 best nodes, best first, picked with a bounded min-heap
+static vector<pair<int, double>> select_top(const vector<double> &ranks, int count)
+{
+    typedef pair<double, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+    for (int v = 0; v < ranks.size(); v++)
+    {
+        if (heap.size() < count)
+            heap.push({ranks[v], v});
+        else if (ranks[v] > heap.top().first)
+        {
+            heap.pop();
+            heap.push({ranks[v], v});
+        }
+    }
+
+    vector<pair<int, double>> top(heap.size());
+    for (int i = top.size() - 1; i >= 0; i--)
+    {
+        top[i] = {heap.top().second, heap.top().first};
+        heap.pop();
+    }
+    return top;
+}
+
+vector<pair<int, double>> PageRank::run_top_k(const CsrGraph &graph, int k)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = this->options.tolerance;
+    int n = graph.num_nodes;
+    double d = this->options.damping;
+    k = max(0, min(k, n));
+    this->ranks.assign(n, n > 0 ? 1.0 / n : 0.0);
+
+    vector<double> contrib(n);
+    vector<double> next(n);
+    vector<pair<int, double>> top;
+
+    for (int it = 0; it < this->options.max_iterations && k > 0; it++)
+    {
+        double dangling = compute_contributions(graph, this->ranks, contrib);
+        double base = (1.0 - d) / n + d * dangling / n;
+        auto update = [&](int v, double incoming)
+        {
+            next[v] = base + d * incoming;
+            return fabs(next[v] - this->ranks[v]);
+        };
+        double residual = spmv<PlusTimes<double>>(graph, contrib.data(), update);
+
+        this->ranks.swap(next);
+        this->stats.iterations++;
+        this->stats.residual = residual;
+        this->stats.edges_processed += graph.num_edges();
+
+        if (residual < this->options.tolerance)
+        {
+            this->stats.converged = true;
+            break;
+        }
+
+        // The remaining error e satisfies |e|_1 <= d / (1 - d) * residual, and two
+        // nodes can only swap if their gap is below |e_i| + |e_j| <= |e|_1
+        double bound = d / (1.0 - d) * residual;
+        top = select_top(this->ranks, k + 1);
+        bool stable = true;
+        for (int i = 0; i + 1 < top.size() && stable; i++)
+            stable = top[i].second - top[i + 1].second > bound;
+        if (stable)
+        {
+            this->stats.converged = true;
+            break;
+        }
+    }
+
+    top = select_top(this->ranks, k);
+    return top;
+}
@@ -0,0 +1,164 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "compressed_graph.h"
+#include "coo_graph.h"
+#include "csr_graph.h"
+
+using namespace std;
+
+enum class PageRankMode
+{
+    // Plain power iteration, every node is recomputed each iteration
+    POWER,
+    // Strongly connected components are solved one at a time in topological
+    // order, each one only sees contributions from converged upstream ones
+    COMPONENTS,
+    // BlockRank: local PageRank inside each block (graph.blocks), PageRank of
+    // the block graph, then a global power iteration warm-started from both
+    BLOCK,
+    // Asynchronous residual pushes without iteration barriers. Threads take the
+    // nodes with the largest residual from their own priority buckets and steal
+    // from the others when idle. stats.iterations stays 0, compare runs through
+    // stats.edges_processed. Pushes stop after max_iterations * num_edges edge
+    // reads, the budget of power iteration
+    ASYNC
+};
+
+enum class PageRankKernel
+{
+    // Node-parallel gather over the CSR in-edges
+    PULL,
+    // Edge-parallel scatter over a COO edge array grouped by target range,
+    // each range scattered by one thread into its own slice of the output.
+    // A range holding an in-hub is cut into pieces of the average edge load
+    // whose partial sums are merged at the end, so hubs do not stall a thread
+    EDGE_CENTRIC
+};
+
+struct PageRankOptions
+{
+    PageRankMode mode = PageRankMode::POWER;
+    // Power mode kernel, with the edge order used by EDGE_CENTRIC
+    PageRankKernel kernel = PageRankKernel::PULL;
+    EdgeOrder edge_order = EdgeOrder::SOURCE;
+    double damping = 0.85;
+    // Stop once the L1 change between two iterations drops below this
+    double tolerance = 1e-8;
+    int max_iterations = 100;
+
+    // Power mode: apply quadratic extrapolation (Kamvar et al.) to the iterate
+    // sequence every extrapolation_interval iterations, 0 disables it
+    // Mostly useful when damping is close to 1
+    int extrapolation_interval = 0;
+
+    // Power mode: keep the rank and contribution vectors in float, halving the
+    // bytes moved per edge. Sums are still accumulated in double
+    // Float ranks cannot resolve L1 changes below their rounding noise, so the
+    // tolerance is raised to at least 4 * FLT_EPSILON (about 4.8e-7), see
+    // stats.tolerance for the value a run was actually checked against
+    bool single_precision = false;
+};
+
+struct PageRankStats
+{
+    int iterations = 0;
+    double residual = 0.0;
+    bool converged = false;
+    // Tolerance the residual was compared with, options.tolerance unless
+    // single_precision raised it
+    double tolerance = 0.0;
+    // Number of in-edges read by the kernel over the whole run
+    int64_t edges_processed = 0;
+    int components = 0;
+    // BlockRank: iterations of the slowest local solve and of the block graph
+    int local_iterations = 0;
+    int block_iterations = 0;
+    int extrapolations = 0;
+    // Estimated iterations plain power iteration would have needed on top of
+    // the ones actually run, from the slowest residual decay rate seen between
+    // iterations not disturbed by an extrapolation
+    int iterations_saved = 0;
+};
+
+class PageRank
+{
+public:
+    PageRankOptions options;
+    PageRankStats stats;
+    // Score of each node id, they sum to 1
+    vector<double> ranks;
+
+    PageRank(PageRankOptions options);
+
+    // Compute the ranks of every node of the graph
+    const vector<double> &run(const CsrGraph &graph);
+
+    // Same, starting from initial (rescaled to sum to 1) instead of the uniform
+    // vector, which is used when initial does not match the graph
+    // Power mode continues from it, the others start over
+    const vector<double> &run(const CsrGraph &graph, const vector<double> &initial);
+
+    // Out-of-core power iteration: only the rank vectors are kept in memory and
+    // the edges are streamed from an edge file (see edge_file.h) every iteration
+    // Returns false if the file could not be read
+    bool run_out_of_core(const string &edge_file);
+
+    // Power iteration split over num_shards worker processes, each one owning a
+    // contiguous range of nodes. Contributions are exchanged through a POSIX
+    // shared memory segment with a barrier per iteration (Linux only)
+    bool run_sharded(const CsrGraph &graph, int num_shards);
+
+    // Power iteration over the gap-encoded lists of a CompressedGraph, trading
+    // decoding work for a smaller footprint. Ignores options.mode
+    const vector<double> &run_compressed(const CompressedGraph &graph);
+
+    // Compute PageRank for several damping factors in one pass over the edges
+    // The K rank vectors are interleaved per node, so each in-edge is read once
+    // for all of them. Returns one rank vector per damping factor, ranks is left
+    // untouched and stats.iterations is the count of the slowest one
+    vector<vector<double>> run_damping_sweep(const CsrGraph &graph, const vector<double> &dampings);
+
+    // Top-k query: the k best (node, score) pairs, best first
+    // Iterating stops as soon as the top-k set and order are provably final,
+    // i.e. every gap around and inside the top-k exceeds the remaining L1 error
+    // bound damping / (1 - damping) * residual, or at the regular tolerance
+    vector<pair<int, double>> run_top_k(const CsrGraph &graph, int k);
+
+    // options.tolerance, raised to the float floor when single_precision
+    // applies (power mode only)
+    double effective_tolerance() const;
+
+private:
+    void power_iteration(const CsrGraph &graph);
+    bool extrapolate(const vector<double> &x1, const vector<double> &x2, const vector<double> &x3);
+    void component_iteration(const CsrGraph &graph);
+    void block_iteration(const CsrGraph &graph);
+    void float_power_iteration(const CsrGraph &graph);
+    void edge_centric_iteration(const CsrGraph &graph);
+    void async_iteration(const CsrGraph &graph);
+};
+
+// Each node u pushes ranks[u] / out_degree(u) along its out-edges
+// Nodes without out-edges spread their rank uniformly, the returned value is that total
+double compute_contributions(const CsrGraph &graph, const vector<double> &ranks, vector<double> &contrib);
+
+// Differences between a single and a double precision run of the same options
+struct PrecisionReport
+{
+    double l1_error = 0.0;
+    double max_relative_error = 0.0;
+    // Positions of the top_k best nodes that differ between both runs
+    int top_k_mismatches = 0;
+    double double_seconds = 0.0;
+    double single_seconds = 0.0;
+    PageRankStats double_stats;
+    PageRankStats single_stats;
+};
+
+// Validation harness for PageRankOptions::single_precision
+PrecisionReport validate_precision(const CsrGraph &graph, PageRankOptions options, int top_k = 100);
+#endif
@@ -0,0 +1,130 @@
+#include "personalized_pagerank.h"
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+BidirectionalPpr::BidirectionalPpr(const CsrGraph &graph, PprOptions options)
+    : options{options}, graph{graph}, rng{options.seed}
+{
+    this->estimates.assign(graph.num_nodes, 0.0);
+    this->residuals.assign(graph.num_nodes, 0.0);
+    this->queued.assign(graph.num_nodes, 0);
+}
+
+double BidirectionalPpr::estimate(int source, int target)
+{
+    this->stats = PprStats();
+    reverse_push(target);
+
+    double sum = 0.0;
+    for (int i = 0; i < this->options.num_walks; i++)
+    {
+        int end = walk(source);
+        if (end >= 0)
+            sum += this->residuals[end];
+    }
+
+    double result = this->estimates[source];
+    if (this->options.num_walks > 0)
+        result += sum / this->options.num_walks;
+    clear();
+    return result;
+}
+
+Contributions BidirectionalPpr::top_contributors(int target, int k)
+{
+    this->stats = PprStats();
+    reverse_push(target);
+
+    int n = this->graph.num_nodes;
+    Contributions result;
+    for (int v : this->touched)
+    {
+        if (this->estimates[v] <= 0.0)
+            continue;
+        result.sources.push_back({v, this->estimates[v] / n});
+        result.total += this->estimates[v] / n;
+    }
+    result.max_error = this->options.r_max / n;
+
+    auto better = [](const pair<int, double> &a, const pair<int, double> &b)
+    {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    };
+    k = min<int>(k, result.sources.size());
+    partial_sort(result.sources.begin(), result.sources.begin() + k, result.sources.end(), better);
+    result.sources.resize(k);
+
+    clear();
+    return result;
+}
+
+// Pushing v keeps alpha of its residual as estimate and hands the rest to its
+// in-neighbors u, each weighted by the chance 1 / out_degree(u) of stepping to v
+void BidirectionalPpr::reverse_push(int target)
+{
+    double alpha = this->options.alpha;
+    deque<int> pending;
+    this->residuals[target] = 1.0;
+    this->touched.push_back(target);
+    this->queued[target] = 1;
+    pending.push_back(target);
+
+    while (!pending.empty())
+    {
+        int v = pending.front();
+        pending.pop_front();
+        this->queued[v] = 0;
+
+        double r = this->residuals[v];
+        this->residuals[v] = 0.0;
+        this->estimates[v] += alpha * r;
+        this->stats.pushes++;
+
+        for (int64_t e = this->graph.in_offsets[v]; e < this->graph.in_offsets[v + 1]; e++)
+        {
+            int u = this->graph.in_sources[e];
+            if (this->residuals[u] == 0.0 && this->estimates[u] == 0.0)
+                this->touched.push_back(u);
+            this->residuals[u] += (1.0 - alpha) * r / this->graph.out_degree(u);
+            if (!this->queued[u] && this->residuals[u] > this->options.r_max)
+            {
+                this->queued[u] = 1;
+                pending.push_back(u);
+            }
+        }
+        this->stats.edges_processed += this->graph.in_degree(v);
+    }
+}
+
+void BidirectionalPpr::clear()
+{
+    for (int v : this->touched)
+    {
+        this->estimates[v] = 0.0;
+        this->residuals[v] = 0.0;
+    }
+    this->touched.clear();
+}
+
+// Same step as Universe::update_walkers, a uniformly chosen neighbor, on the
+// CSR out-edges. The number of steps before stopping is geometric, so it is
+// drawn once instead of testing the stop chance at every step
+int BidirectionalPpr::walk(int source)
+{
+    geometric_distribution<int> length(this->options.alpha);
+    int v = source;
+    for (int steps = length(this->rng); steps > 0; steps--)
+    {
+        int degree = this->graph.out_degree(v);
+        if (degree == 0)
+            return -1;
+        v = this->graph.out_targets[this->graph.out_offsets[v] + this->rng() % degree];
+        this->stats.walk_steps++;
+    }
+    return v;
+}
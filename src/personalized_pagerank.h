@@ -0,0 +1,86 @@
+#ifndef PERSONALIZED_PAGERANK_H
+#define PERSONALIZED_PAGERANK_H
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+struct PprOptions
+{
+    // Probability that a walk stops at each step, 1 - damping
+    double alpha = 0.15;
+    // Reverse push stops once every residual is below this
+    // Larger values move work from the push to the walks
+    double r_max = 1e-4;
+    // The walk term has a standard deviation of at most r_max / sqrt(num_walks)
+    int num_walks = 10000;
+    uint64_t seed = 1;
+};
+
+struct PprStats
+{
+    // Reverse pushes and the in-edges they went through, for the last query
+    int64_t pushes = 0;
+    int64_t edges_processed = 0;
+    // Walk steps taken from the source, for the last query
+    int64_t walk_steps = 0;
+};
+
+// Where the PageRank of one target comes from
+struct Contributions
+{
+    // Best (source, contribution) pairs, best first
+    vector<pair<int, double>> sources;
+    // Sum over every touched source, a lower bound of the target's PageRank
+    double total = 0.0;
+    // Upper bound of the part of any single contribution that was not reached
+    double max_error = 0.0;
+};
+
+// Personalized PageRank pi_s(t): probability that a walk starting at s, which
+// stops with probability alpha at each step and otherwise moves to a uniformly
+// chosen out-neighbor, stops at t. Walks reaching a node without out-edges die
+// without stopping anywhere
+// Pair queries use the BiPPR estimator (Lofgren et al.): a reverse push from t
+// leaves estimates p and residuals r with
+//     pi_s(t) = p[s] + sum over v of pi_s(v) * r[v]
+// and the sum is the mean of r at the stopping nodes of walks from s
+// Scratch vectors are sized once per graph and only the touched entries are
+// reset between queries
+class BidirectionalPpr
+{
+public:
+    PprOptions options;
+    PprStats stats;
+
+    BidirectionalPpr(const CsrGraph &graph, PprOptions options);
+
+    // Unbiased estimate of pi_source(target)
+    double estimate(int source, int target);
+
+    // The k sources contributing most to the PageRank of target, from a reverse
+    // push alone. With uniform teleport PageRank(t) is the sum over s of
+    // pi_s(t) / n, so s contributes pi_s(t) / n, which the push underestimates
+    // by at most r_max / n. Only nodes whose residual exceeded r_max are pushed
+    // Dangling mass is not redistributed here; on graphs with dangling nodes
+    // every score is off by the same normalization factor, the order is not
+    Contributions top_contributors(int target, int k);
+
+private:
+    const CsrGraph &graph;
+    mt19937_64 rng;
+    vector<double> estimates;
+    vector<double> residuals;
+    vector<uint8_t> queued;
+    // Nodes with a non-zero estimate or residual since the last clear
+    vector<int> touched;
+
+    void reverse_push(int target);
+    void clear();
+    // Node where a walk from source stops, -1 if it died
+    int walk(int source);
+};
+#endif
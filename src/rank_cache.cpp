@@ -0,0 +1,175 @@
+#include "rank_cache.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Words hashed per parallel chunk, chunk hashes are then combined in order
+const size_t FINGERPRINT_CHUNK = 1 << 20;
+
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+template <typename T>
+static uint64_t hash_words(const vector<T> &words, uint64_t seed)
+{
+    size_t chunks = (words.size() + FINGERPRINT_CHUNK - 1) / FINGERPRINT_CHUNK;
+    vector<uint64_t> partial(chunks);
+
+#pragma omp parallel for
+    for (size_t c = 0; c < chunks; c++)
+    {
+        uint64_t h = c;
+        size_t end = min(words.size(), (c + 1) * FINGERPRINT_CHUNK);
+        for (size_t i = c * FINGERPRINT_CHUNK; i < end; i++)
+            h = (h ^ (uint64_t)words[i]) * 0x100000001b3ULL;
+        partial[c] = h;
+    }
+
+    uint64_t h = mix(seed ^ words.size());
+    for (uint64_t p : partial)
+        h = mix(h ^ p);
+    return h;
+}
+
+uint64_t graph_fingerprint(const CsrGraph &graph)
+{
+    uint64_t h = mix(graph.num_nodes);
+    h = hash_words(graph.out_offsets, h);
+    return hash_words(graph.out_targets, h);
+}
+
+RankCache::RankCache(const string &directory) : hit{false}, warm_started{false}, directory{directory}
+{
+}
+
+bool RankCache::run(PageRank &engine, const CsrGraph &graph)
+{
+    this->hit = false;
+    this->warm_started = false;
+
+    uint64_t fingerprint = graph_fingerprint(graph);
+    double damping = engine.options.damping;
+    double tolerance = engine.effective_tolerance();
+    int32_t mode = (int32_t)engine.options.mode;
+    int32_t single_precision = engine.options.single_precision && engine.options.mode == PageRankMode::POWER;
+
+    // Entries are named after their graph, only those headers are read
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "%016llx_", (unsigned long long)fingerprint);
+
+    string closest;
+    double closest_distance = INFINITY;
+    error_code error;
+    for (const auto &entry : filesystem::directory_iterator(this->directory, error))
+    {
+        string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) != 0 || entry.path().extension() != ".rank")
+            continue;
+
+        RankCacheHeader header;
+        if (!read_entry(entry.path().string(), header, nullptr) || header.fingerprint != fingerprint || header.num_nodes != graph.num_nodes)
+            continue;
+
+        if (header.damping == damping && header.tolerance <= tolerance && header.mode == mode &&
+            header.single_precision == single_precision)
+        {
+            if (!read_entry(entry.path().string(), header, &engine.ranks))
+                continue;
+            engine.stats = PageRankStats();
+            engine.stats.converged = true;
+            engine.stats.tolerance = header.tolerance;
+            this->hit = true;
+            return true;
+        }
+
+        double distance = fabs(header.damping - damping);
+        if (distance < closest_distance)
+        {
+            closest = entry.path().string();
+            closest_distance = distance;
+        }
+    }
+
+    vector<double> initial;
+    RankCacheHeader header;
+    if (!closest.empty() && read_entry(closest, header, &initial))
+        this->warm_started = true;
+    engine.run(graph, initial);
+
+    // A run cut off by max_iterations does not meet its tolerance
+    if (!engine.stats.converged)
+        return true;
+    header = {RANK_CACHE_MAGIC, graph.num_nodes, fingerprint, damping, engine.stats.tolerance, mode, single_precision};
+    return write_entry(header, engine.ranks);
+}
+
+// Reads the header, and the ranks too when ranks is not null
+bool RankCache::read_entry(const string &path, RankCacheHeader &header, vector<double> *ranks) const
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return false;
+
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == RANK_CACHE_MAGIC && header.num_nodes >= 0;
+    if (ok && ranks != nullptr)
+    {
+        ranks->resize(header.num_nodes);
+        ok = fread(ranks->data(), sizeof(double), header.num_nodes, file) == header.num_nodes;
+    }
+    fclose(file);
+    return ok;
+}
+
+// Written under a temporary name and renamed, so readers never see half an entry
+bool RankCache::write_entry(const RankCacheHeader &header, const vector<double> &ranks) const
+{
+    error_code error;
+    filesystem::create_directories(this->directory, error);
+
+    uint64_t damping_bits;
+    uint64_t tolerance_bits;
+    memcpy(&damping_bits, &header.damping, sizeof(double));
+    memcpy(&tolerance_bits, &header.tolerance, sizeof(double));
+    char name[128];
+    snprintf(name, sizeof(name), "%016llx_%d_%d_%016llx_%016llx.rank", (unsigned long long)header.fingerprint, header.mode,
+             header.single_precision, (unsigned long long)damping_bits, (unsigned long long)tolerance_bits);
+    filesystem::path path = filesystem::path(this->directory) / name;
+    filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    FILE *file = fopen(temporary.string().c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::cout << "ERROR::RANK_CACHE::OPEN_FAILED\n"
+                  << temporary.string() << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok &= fwrite(ranks.data(), sizeof(double), ranks.size(), file) == ranks.size();
+    ok &= fclose(file) == 0;
+
+    if (ok)
+    {
+        filesystem::rename(temporary, path, error);
+        ok = !error;
+    }
+    if (!ok)
+    {
+        std::cout << "ERROR::RANK_CACHE::WRITE_FAILED\n"
+                  << path.string() << std::endl;
+        filesystem::remove(temporary, error);
+    }
+    return ok;
+}
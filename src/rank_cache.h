@@ -0,0 +1,54 @@
+#ifndef RANK_CACHE_H
+#define RANK_CACHE_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "csr_graph.h"
+#include "pagerank.h"
+
+using namespace std;
+
+// Cache entry: a header followed by num_nodes doubles
+struct RankCacheHeader
+{
+    uint32_t magic;
+    int32_t num_nodes;
+    uint64_t fingerprint;
+    double damping;
+    // Effective tolerance of the run (see PageRankStats::tolerance)
+    double tolerance;
+    // PageRankMode of the run and whether it kept float vectors
+    int32_t mode;
+    int32_t single_precision;
+};
+
+const uint32_t RANK_CACHE_MAGIC = 0x33524B50; // "PKR3"
+
+// Content hash of the graph structure, equal graphs get equal fingerprints
+uint64_t graph_fingerprint(const CsrGraph &graph);
+
+// PageRank vectors kept on disk, one file per (graph, mode, precision, damping, tolerance)
+class RankCache
+{
+public:
+    // How the last run was served
+    bool hit;
+    bool warm_started;
+
+    RankCache(const string &directory);
+
+    // Ranks of graph with engine.options, left in engine.ranks and engine.stats
+    // An entry of the same graph, mode, precision and damping with an effective
+    // tolerance at least as tight is returned as is. Otherwise the engine runs
+    // warm-started from the entry of the same graph with the closest damping,
+    // if any, and the result is stored only if the run converged
+    // Returns false if the cache directory could not be written
+    bool run(PageRank &engine, const CsrGraph &graph);
+
+private:
+    string directory;
+
+    bool read_entry(const string &path, RankCacheHeader &header, vector<double> *ranks) const;
+    bool write_entry(const RankCacheHeader &header, const vector<double> &ranks) const;
+};
+#endif
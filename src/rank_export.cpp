@@ -0,0 +1,176 @@
+#include "rank_export.h"
+#include <charconv>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+// Lines per formatting chunk, and chunks per thread in one round
+const int64_t EXPORT_CHUNK_LINES = 1 << 16;
+const int EXPORT_CHUNKS_PER_THREAD = 4;
+// Longest line: a position, a node id, a double and the separators
+const int MAX_LINE_LENGTH = 64;
+
+static bool report_write_failure(const string &path)
+{
+    std::cout << "ERROR::RANK_EXPORT::WRITE_FAILED\n"
+              << path << std::endl;
+    return false;
+}
+
+static char *format_score(char *out, double score)
+{
+    return to_chars(out, out + 32, score).ptr;
+}
+
+static char *format_int(char *out, int64_t value)
+{
+    return to_chars(out, out + 24, value).ptr;
+}
+
+// Write header then format(i, out) for every line i < count
+// format writes one line at out and returns the end of it
+static bool write_lines(const string &path, const string &header, int64_t count, const function<char *(int64_t, char *)> &format)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return report_write_failure(path);
+    bool ok = fwrite(header.data(), 1, header.size(), file) == header.size();
+    ok &= fflush(file) == 0;
+    int64_t offset = header.size();
+
+#ifdef _OPENMP
+    int threads = omp_get_max_threads();
+#else
+    int threads = 1;
+#endif
+    int64_t chunks = (count + EXPORT_CHUNK_LINES - 1) / EXPORT_CHUNK_LINES;
+    int64_t round_chunks = (int64_t)threads * EXPORT_CHUNKS_PER_THREAD;
+    vector<string> buffers(min(chunks, round_chunks));
+    vector<int64_t> offsets(buffers.size() + 1);
+
+    for (int64_t first = 0; first < chunks && ok; first += round_chunks)
+    {
+        int64_t last = min(chunks, first + round_chunks);
+
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int64_t c = first; c < last; c++)
+        {
+            string &buffer = buffers[c - first];
+            int64_t begin = c * EXPORT_CHUNK_LINES;
+            int64_t end = min(count, begin + EXPORT_CHUNK_LINES);
+            buffer.resize((end - begin) * MAX_LINE_LENGTH);
+            char *out = buffer.data();
+            for (int64_t i = begin; i < end; i++)
+                out = format(i, out);
+            buffer.resize(out - buffer.data());
+        }
+
+        offsets[0] = offset;
+        for (int64_t c = first; c < last; c++)
+            offsets[c - first + 1] = offsets[c - first] + buffers[c - first].size();
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+        int fd = fileno(file);
+        int failed = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : failed)
+        for (int64_t c = first; c < last; c++)
+        {
+            const string &buffer = buffers[c - first];
+            size_t written = 0;
+            while (written < buffer.size())
+            {
+                ssize_t result = pwrite(fd, buffer.data() + written, buffer.size() - written, offsets[c - first] + written);
+                if (result <= 0)
+                {
+                    failed++;
+                    break;
+                }
+                written += result;
+            }
+        }
+        ok &= failed == 0;
+#else
+        for (int64_t c = first; c < last && ok; c++)
+            ok = fwrite(buffers[c - first].data(), 1, buffers[c - first].size(), file) == buffers[c - first].size();
+#endif
+        offset = offsets[last - first];
+    }
+
+    ok &= fclose(file) == 0;
+    return ok ? true : report_write_failure(path);
+}
+
+bool write_ranks_csv(const string &path, const vector<double> &ranks)
+{
+    auto format = [&](int64_t v, char *out)
+    {
+        out = format_int(out, v);
+        *out++ = ',';
+        out = format_score(out, ranks[v]);
+        *out++ = '\n';
+        return out;
+    };
+    return write_lines(path, "node,score\n", ranks.size(), format);
+}
+
+bool write_top_k_csv(const string &path, const vector<pair<int, double>> &top)
+{
+    auto format = [&](int64_t i, char *out)
+    {
+        out = format_int(out, i + 1);
+        *out++ = ',';
+        out = format_int(out, top[i].first);
+        *out++ = ',';
+        out = format_score(out, top[i].second);
+        *out++ = '\n';
+        return out;
+    };
+    return write_lines(path, "position,node,score\n", top.size(), format);
+}
+
+bool write_ranks_binary(const string &path, const vector<double> &ranks)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return report_write_failure(path);
+
+    RankFileHeader header = {RANK_FILE_MAGIC, (int32_t)ranks.size(), (int64_t)ranks.size()};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok &= fwrite(ranks.data(), sizeof(double), ranks.size(), file) == ranks.size();
+    ok &= fclose(file) == 0;
+    return ok ? true : report_write_failure(path);
+}
+
+bool write_top_k_binary(const string &path, int num_nodes, const vector<pair<int, double>> &top)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return report_write_failure(path);
+
+    vector<int32_t> nodes(top.size());
+    vector<double> scores(top.size());
+    for (size_t i = 0; i < top.size(); i++)
+    {
+        nodes[i] = top[i].first;
+        scores[i] = top[i].second;
+    }
+
+    RankFileHeader header = {TOP_K_FILE_MAGIC, num_nodes, (int64_t)top.size()};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok &= fwrite(nodes.data(), sizeof(int32_t), nodes.size(), file) == nodes.size();
+    ok &= fwrite(scores.data(), sizeof(double), scores.size(), file) == scores.size();
+    ok &= fclose(file) == 0;
+    return ok ? true : report_write_failure(path);
+}
@@ -0,0 +1,33 @@
+#ifndef RANK_EXPORT_H
+#define RANK_EXPORT_H
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Binary score file: a header followed by either num_nodes scores in node
+// order (RANK_FILE_MAGIC) or count node ids then their count scores, best
+// first (TOP_K_FILE_MAGIC)
+struct RankFileHeader
+{
+    uint32_t magic;
+    int32_t num_nodes;
+    int64_t count;
+};
+
+const uint32_t RANK_FILE_MAGIC = 0x53524B50;  // "PKRS"
+const uint32_t TOP_K_FILE_MAGIC = 0x54524B50; // "PKRT"
+
+// Every writer returns false and prints the path if the file cannot be written
+bool write_ranks_binary(const string &path, const vector<double> &ranks);
+bool write_top_k_binary(const string &path, int num_nodes, const vector<pair<int, double>> &top);
+
+// CSV with a header line, "node,score" or "position,node,score" for top-k lists
+// Scores are printed with the shortest representation that reads back exactly
+// Lines are formatted in parallel in chunks, each round of chunks is then
+// written at its offset concurrently (in order where pwrite is not available)
+bool write_ranks_csv(const string &path, const vector<double> &ranks);
+bool write_top_k_csv(const string &path, const vector<pair<int, double>> &top);
+#endif
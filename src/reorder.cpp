@@ -0,0 +1,253 @@
+#include "reorder.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+// Label propagation stops after this many rounds or once fewer than
+// num_nodes / LABEL_STABLE_FRACTION labels change in a round
+const int MAX_LABEL_ROUNDS = 20;
+const int LABEL_STABLE_FRACTION = 1000;
+
+static int total_degree(const CsrGraph &graph, int v)
+{
+    return graph.out_degree(v) + graph.in_degree(v);
+}
+
+// Visit the undirected neighbors of v, an arc in both directions is seen twice
+template <typename Visit>
+static void for_each_neighbor(const CsrGraph &graph, int v, Visit visit)
+{
+    for (int64_t e = graph.out_offsets[v]; e < graph.out_offsets[v + 1]; e++)
+        visit(graph.out_targets[e]);
+    for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; e++)
+        visit(graph.in_sources[e]);
+}
+
+static vector<int> degree_order(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    vector<int> degree(n);
+#pragma omp parallel for
+    for (int v = 0; v < n; v++)
+        degree[v] = total_degree(graph, v);
+
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](int a, int b)
+                { return degree[a] > degree[b]; });
+    return order;
+}
+
+static vector<int> rcm_order(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    vector<int> degree(n);
+#pragma omp parallel for
+    for (int v = 0; v < n; v++)
+        degree[v] = total_degree(graph, v);
+
+    // Roots are tried from the lowest degree up, a cheap stand-in for a
+    // peripheral node of each component
+    vector<int> roots(n);
+    iota(roots.begin(), roots.end(), 0);
+    stable_sort(roots.begin(), roots.end(), [&](int a, int b)
+                { return degree[a] < degree[b]; });
+
+    vector<int> order;
+    order.reserve(n);
+    vector<uint8_t> visited(n, 0);
+    for (int root : roots)
+    {
+        if (visited[root])
+            continue;
+        visited[root] = 1;
+        order.push_back(root);
+
+        // order doubles as the BFS queue, each node's new children are
+        // appended by increasing degree
+        for (size_t head = order.size() - 1; head < order.size(); head++)
+        {
+            size_t first_child = order.size();
+            auto enqueue = [&](int w)
+            {
+                if (!visited[w])
+                {
+                    visited[w] = 1;
+                    order.push_back(w);
+                }
+            };
+            for_each_neighbor(graph, order[head], enqueue);
+            stable_sort(order.begin() + first_child, order.end(), [&](int a, int b)
+                        { return degree[a] < degree[b]; });
+        }
+    }
+
+    reverse(order.begin(), order.end());
+    return order;
+}
+
+// Synchronous label propagation: every node takes the label most common among
+// its neighbors, keeping its own on ties so labels do not oscillate
+static vector<int> propagate_labels(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    vector<int> label(n);
+    iota(label.begin(), label.end(), 0);
+    vector<int> next(n);
+
+    for (int round = 0; round < MAX_LABEL_ROUNDS; round++)
+    {
+        int64_t changed = 0;
+
+#pragma omp parallel reduction(+ : changed)
+        {
+            // Open addressing table of (label, count), sized to a power of two
+            // at least twice the degree and reset through the slots touched
+            vector<pair<int, int>> table;
+            vector<int> touched;
+
+#pragma omp for schedule(dynamic, 1024)
+            for (int v = 0; v < n; v++)
+            {
+                size_t degree = total_degree(graph, v);
+                if (table.size() < 2 * degree)
+                    table.assign(bit_ceil(2 * degree), {-1, 0});
+                size_t mask = table.size() - 1;
+
+                int best = label[v];
+                int best_count = 0;
+                auto tally = [&](int w)
+                {
+                    int l = label[w];
+                    size_t slot = (uint32_t)l * 0x9E3779B1u & mask;
+                    while (table[slot].first != l && table[slot].first != -1)
+                        slot = (slot + 1) & mask;
+                    if (table[slot].first == -1)
+                    {
+                        table[slot].first = l;
+                        touched.push_back(slot);
+                    }
+                    int count = ++table[slot].second;
+                    if (count > best_count || (count == best_count && l < best))
+                    {
+                        best = l;
+                        best_count = count;
+                    }
+                };
+                for_each_neighbor(graph, v, tally);
+
+                // The node's own label wins ties
+                for (int slot : touched)
+                {
+                    if (table[slot].first == label[v] && table[slot].second == best_count)
+                        best = label[v];
+                    table[slot] = {-1, 0};
+                }
+                touched.clear();
+
+                next[v] = best;
+                changed += best != label[v];
+            }
+        }
+
+        label.swap(next);
+        if (changed <= n / LABEL_STABLE_FRACTION)
+            break;
+    }
+    return label;
+}
+
+static vector<int> community_order(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    vector<int> label = propagate_labels(graph);
+    vector<int> degree(n);
+    vector<int> size(n, 0);
+#pragma omp parallel for
+    for (int v = 0; v < n; v++)
+        degree[v] = total_degree(graph, v);
+    for (int v = 0; v < n; v++)
+        size[label[v]]++;
+
+    // Largest communities first, ties by label so the order is deterministic
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    auto before = [&](int a, int b)
+    {
+        int la = label[a];
+        int lb = label[b];
+        if (la != lb)
+            return size[la] != size[lb] ? size[la] > size[lb] : la < lb;
+        return degree[a] != degree[b] ? degree[a] > degree[b] : a < b;
+    };
+    sort(order.begin(), order.end(), before);
+    return order;
+}
+
+// Renumber one direction of the adjacency and sort the relabeled lists
+static void permute_lists(const vector<int64_t> &offsets, const vector<int> &neighbors, const vector<int> &new_id,
+                          const vector<int> &old_id, vector<int64_t> &permuted_offsets, vector<int> &permuted)
+{
+    int n = old_id.size();
+    permuted_offsets.assign(n + 1, 0);
+    for (int i = 0; i < n; i++)
+        permuted_offsets[i + 1] = permuted_offsets[i] + offsets[old_id[i] + 1] - offsets[old_id[i]];
+    permuted.resize(neighbors.size());
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < n; i++)
+    {
+        int64_t out = permuted_offsets[i];
+        for (int64_t e = offsets[old_id[i]]; e < offsets[old_id[i] + 1]; e++)
+            permuted[out++] = new_id[neighbors[e]];
+        sort(permuted.begin() + permuted_offsets[i], permuted.begin() + permuted_offsets[i + 1]);
+    }
+}
+
+Reordering reorder_graph(const CsrGraph &graph, NodeOrdering ordering)
+{
+    Reordering reordering;
+    switch (ordering)
+    {
+    case NodeOrdering::DEGREE:
+        reordering.old_id = degree_order(graph);
+        break;
+    case NodeOrdering::RCM:
+        reordering.old_id = rcm_order(graph);
+        break;
+    case NodeOrdering::COMMUNITY:
+        reordering.old_id = community_order(graph);
+        break;
+    }
+
+    int n = graph.num_nodes;
+    reordering.new_id.resize(n);
+    for (int i = 0; i < n; i++)
+        reordering.new_id[reordering.old_id[i]] = i;
+
+    CsrGraph &permuted = reordering.graph;
+    permuted.num_nodes = n;
+    permute_lists(graph.out_offsets, graph.out_targets, reordering.new_id, reordering.old_id, permuted.out_offsets, permuted.out_targets);
+    permute_lists(graph.in_offsets, graph.in_sources, reordering.new_id, reordering.old_id, permuted.in_offsets, permuted.in_sources);
+    if (graph.blocks.size() == n)
+    {
+        permuted.blocks.resize(n);
+        for (int i = 0; i < n; i++)
+            permuted.blocks[i] = graph.blocks[reordering.old_id[i]];
+    }
+    return reordering;
+}
+
+vector<double> restore_order(const Reordering &reordering, const vector<double> &values)
+{
+    int n = reordering.new_id.size();
+    vector<double> original(n);
+#pragma omp parallel for
+    for (int v = 0; v < n; v++)
+        original[v] = values[reordering.new_id[v]];
+    return original;
+}
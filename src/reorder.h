@@ -0,0 +1,35 @@
+#ifndef REORDER_H
+#define REORDER_H
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+enum class NodeOrdering
+{
+    // Highest in + out degree first, hubs share cache lines
+    DEGREE,
+    // Reverse Cuthill-McKee over the undirected view, BFS levels become
+    // contiguous ranges and the bandwidth of the adjacency matrix shrinks
+    RCM,
+    // Label propagation communities, each one a contiguous range with its
+    // nodes by descending degree
+    COMMUNITY
+};
+
+// Relabeled copy of a graph
+// Node v of the original graph is node new_id[v] of graph, and node i of
+// graph is node old_id[i] of the original one
+struct Reordering
+{
+    CsrGraph graph;
+    vector<int> new_id;
+    vector<int> old_id;
+};
+
+// Compute the ordering and build the permuted CSR, neighbor lists stay sorted
+Reordering reorder_graph(const CsrGraph &graph, NodeOrdering ordering);
+
+// Map per-node values computed on the reordered graph back to original ids
+vector<double> restore_order(const Reordering &reordering, const vector<double> &values);
+#endif
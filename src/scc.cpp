@@ -0,0 +1,306 @@
+#include "scc.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Trimming is cheap per round but a long chain would need one round per node
+const int MAX_TRIM_ROUNDS = 8;
+// Subproblems up to this size go through a serial Tarjan instead of two BFS
+const int SERIAL_SCC_SIZE = 4096;
+// A pivot whose component holds less than 1 / MIN_PIVOT_SHARE of its
+// subproblem sends the remaining parts to Tarjan. Peeling small components
+// one BFS pair at a time would be quadratic, e.g. on a chain of cycles
+const int MIN_PIVOT_SHARE = 8;
+// BFS levels with fewer nodes than this are expanded serially
+const int PARALLEL_FRONTIER = 1024;
+
+// Nodes of the subproblem with this label reachable from pivot, following
+// out-edges (forward) or in-edges (backward). Level-synchronous parallel BFS
+static void reach(const CsrGraph &graph, int pivot, bool forward, const vector<int> &label, vector<uint8_t> &mark)
+{
+    const vector<int64_t> &offsets = forward ? graph.out_offsets : graph.in_offsets;
+    const vector<int> &neighbors = forward ? graph.out_targets : graph.in_sources;
+    int id = label[pivot];
+
+    vector<int> frontier{pivot};
+    mark[pivot] = 1;
+    while (!frontier.empty())
+    {
+        vector<int> next;
+#pragma omp parallel if (frontier.size() >= PARALLEL_FRONTIER)
+        {
+            vector<int> local;
+#pragma omp for schedule(dynamic, 256) nowait
+            for (size_t i = 0; i < frontier.size(); i++)
+            {
+                int v = frontier[i];
+                for (int64_t e = offsets[v]; e < offsets[v + 1]; e++)
+                {
+                    int w = neighbors[e];
+                    if (label[w] == id && mark[w] == 0 && atomic_ref<uint8_t>(mark[w]).exchange(1) == 0)
+                        local.push_back(w);
+                }
+            }
+#pragma omp critical
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        frontier.swap(next);
+    }
+}
+
+// Iterative Tarjan over the nodes of one subproblem. Tarjan finishes
+// components in reverse topological order, so they are written backwards
+// into nodes, and the position of each component's first node is flagged
+static void tarjan(const CsrGraph &graph, int *nodes, int size, vector<int> &label, vector<int> &index,
+                   vector<int> &low, vector<uint8_t> &on_stack, vector<uint8_t> &first)
+{
+    int id = label[nodes[0]];
+    vector<int> members(nodes, nodes + size);
+    vector<int> stack;
+    vector<pair<int, int64_t>> call_stack;
+    int counter = 0;
+    int end = size;
+
+    for (int root : members)
+    {
+        if (index[root] >= 0)
+            continue;
+
+        call_stack.push_back({root, graph.out_offsets[root]});
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = 1;
+
+        while (!call_stack.empty())
+        {
+            auto &[v, e] = call_stack.back();
+            if (e < graph.out_offsets[v + 1])
+            {
+                int w = graph.out_targets[e++];
+                if (label[w] != id)
+                    continue;
+                if (index[w] < 0)
+                {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    on_stack[w] = 1;
+                    call_stack.push_back({w, graph.out_offsets[w]});
+                }
+                else if (on_stack[w])
+                {
+                    low[v] = min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            // All successors of v are done, pop it like a returning recursive call
+            int done = v;
+            call_stack.pop_back();
+            if (!call_stack.empty())
+            {
+                int parent = call_stack.back().first;
+                low[parent] = min(low[parent], low[done]);
+            }
+
+            if (low[done] == index[done])
+            {
+                int w;
+                do
+                {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = 0;
+                    nodes[--end] = w;
+                } while (w != done);
+                first[end] = 1;
+            }
+        }
+    }
+
+    for (int v : members)
+        label[v] = -1;
+}
+
+SccDecomposition strongly_connected_components(const CsrGraph &graph)
+{
+    int n = graph.num_nodes;
+    SccDecomposition scc;
+    scc.component.assign(n, -1);
+
+    // Trim round r: a node with no live predecessor is a source, one with no
+    // live successor is a sink. Each is a component of its own. Sources go
+    // first (earlier rounds first) and sinks last (earlier rounds last)
+    vector<uint8_t> live(n, 1);
+    vector<vector<int>> sources;
+    vector<vector<int>> sinks;
+    for (int round = 0; round < MAX_TRIM_ROUNDS; round++)
+    {
+        vector<uint8_t> kind(n, 0);
+        int64_t trimmed = 0;
+
+#pragma omp parallel for reduction(+ : trimmed)
+        for (int v = 0; v < n; v++)
+        {
+            if (!live[v])
+                continue;
+            bool has_in = false;
+            for (int64_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1] && !has_in; e++)
+                has_in = live[graph.in_sources[e]] && graph.in_sources[e] != v;
+            bool has_out = false;
+            for (int64_t e = graph.out_offsets[v]; e < graph.out_offsets[v + 1] && !has_out; e++)
+                has_out = live[graph.out_targets[e]] && graph.out_targets[e] != v;
+
+            kind[v] = !has_in ? 1 : !has_out ? 2 : 0;
+            trimmed += kind[v] != 0;
+        }
+        if (trimmed == 0)
+            break;
+
+        sources.emplace_back();
+        sinks.emplace_back();
+        for (int v = 0; v < n; v++)
+        {
+            if (kind[v] == 1)
+                sources.back().push_back(v);
+            else if (kind[v] == 2)
+                sinks.back().push_back(v);
+            if (kind[v] != 0)
+                live[v] = 0;
+        }
+    }
+
+    // order lists the nodes in topological order of their components, and
+    // first[p] flags the positions where a component starts. The live nodes
+    // sit between the sources and the sinks and are split further below
+    vector<int> order;
+    order.reserve(n);
+    vector<uint8_t> first(n + 1, 0);
+    for (const auto &round : sources)
+    {
+        for (int v : round)
+        {
+            first[order.size()] = 1;
+            order.push_back(v);
+        }
+    }
+    int live_begin = order.size();
+    for (int v = 0; v < n; v++)
+    {
+        if (live[v])
+            order.push_back(v);
+    }
+    int live_end = order.size();
+    for (int r = sinks.size() - 1; r >= 0; r--)
+    {
+        for (int v : sinks[r])
+        {
+            first[order.size()] = 1;
+            order.push_back(v);
+        }
+    }
+
+    // Forward-backward decomposition: the nodes both reachable from a pivot
+    // and reaching it form its component. Within a subproblem, edges between
+    // parts only leave the backward-only part or enter the forward-only part,
+    // so laying out backward-only, component, rest, forward-only keeps order
+    // topological. The three other parts become subproblems, identified by label
+    vector<int> label(n, -1);
+    for (int p = live_begin; p < live_end; p++)
+        label[order[p]] = 0;
+    int next_label = 1;
+    vector<uint8_t> forward(n, 0);
+    vector<uint8_t> backward(n, 0);
+    vector<int> index(n, -1);
+    vector<int> low(n, 0);
+    vector<uint8_t> on_stack(n, 0);
+
+    struct Subproblem
+    {
+        int begin;
+        int end;
+        bool serial;
+    };
+    vector<Subproblem> work;
+    if (live_end > live_begin)
+        work.push_back({live_begin, live_end, false});
+    while (!work.empty())
+    {
+        Subproblem problem = work.back();
+        work.pop_back();
+        int begin = problem.begin;
+        int *nodes = order.data() + begin;
+        int size = problem.end - begin;
+
+        if (problem.serial || size <= SERIAL_SCC_SIZE)
+        {
+            vector<uint8_t> starts(size, 0);
+            tarjan(graph, nodes, size, label, index, low, on_stack, starts);
+            for (int i = 0; i < size; i++)
+                first[begin + i] = starts[i];
+            continue;
+        }
+
+        // Pivot likely to sit in a large component
+        int pivot = nodes[0];
+        int64_t best = -1;
+        for (int i = 0; i < size; i++)
+        {
+            int v = nodes[i];
+            int64_t score = (int64_t)graph.in_degree(v) * graph.out_degree(v);
+            if (score > best)
+            {
+                best = score;
+                pivot = v;
+            }
+        }
+        reach(graph, pivot, true, label, forward);
+        reach(graph, pivot, false, label, backward);
+
+        // Stable split into backward-only, component, rest, forward-only
+        vector<int> parts[4];
+        for (int i = 0; i < size; i++)
+        {
+            int v = nodes[i];
+            int part = backward[v] && !forward[v] ? 0 : backward[v] ? 1 : !forward[v] ? 2 : 3;
+            parts[part].push_back(v);
+            forward[v] = 0;
+            backward[v] = 0;
+        }
+
+        bool serial = parts[1].size() * MIN_PIVOT_SHARE < size;
+        int position = begin;
+        for (int part = 0; part < 4; part++)
+        {
+            if (parts[part].empty())
+                continue;
+            int part_label = part == 1 ? -1 : next_label++;
+            for (int v : parts[part])
+                label[v] = part_label;
+            copy(parts[part].begin(), parts[part].end(), order.begin() + position);
+            if (part == 1)
+                first[position] = 1;
+            else
+                work.push_back({position, position + (int)parts[part].size(), serial});
+            position += parts[part].size();
+        }
+    }
+
+    // Number the components by position
+    scc.nodes = order;
+    scc.offsets.push_back(0);
+    for (int p = 0; p < n; p++)
+    {
+        if (first[p] && p > 0)
+            scc.offsets.push_back(p);
+        scc.component[order[p]] = scc.offsets.size() - 1;
+    }
+    if (n > 0)
+        scc.offsets.push_back(n);
+    scc.num_components = scc.offsets.size() - 1;
+
+    return scc;
+}
@@ -0,0 +1,26 @@
+#ifndef SCC_H
+#define SCC_H
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+// Strongly connected components of a directed graph
+// Components are numbered in topological order: every edge goes from a
+// component to itself or to a component with a larger id
+struct SccDecomposition
+{
+    int num_components = 0;
+    // Component id of each node
+    vector<int> component;
+    // Nodes grouped by component, component c holds
+    // nodes[offsets[c] .. offsets[c + 1])
+    vector<int> offsets;
+    vector<int> nodes;
+};
+
+// Non-recursive decomposition: nodes without live in- or out-edges are trimmed
+// in parallel rounds first, the rest is split by forward-backward reachability
+// with parallel BFS. Subproblems small enough go through an iterative Tarjan
+SccDecomposition strongly_connected_components(const CsrGraph &graph);
+#endif
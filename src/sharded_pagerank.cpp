@@ -0,0 +1,252 @@
+#include "pagerank.h"
+#include "spmv.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+
+// Per-shard partial sums are padded to a cache line so workers do not share lines
+const int PARTIAL_STRIDE = 8;
+
+// Start of the shared memory segment, the arrays follow it
+struct ShardedSegment
+{
+    pthread_barrier_t barrier;
+    int iterations;
+    int converged;
+    double residual;
+};
+
+struct ShardedLayout
+{
+    ShardedSegment *segment;
+    // Two rank buffers, iteration i reads ranks[i % 2] and writes the other
+    double *ranks[2];
+    double *contrib;
+    double *dangling_partial;
+    double *residual_partial;
+};
+
+static size_t segment_size(int n, int shards)
+{
+    return sizeof(ShardedSegment) + sizeof(double) * (3 * (size_t)n + 2 * PARTIAL_STRIDE * (size_t)shards);
+}
+
+static ShardedLayout map_layout(void *memory, int n, int shards)
+{
+    ShardedLayout layout;
+    layout.segment = (ShardedSegment *)memory;
+    double *arrays = (double *)((char *)memory + sizeof(ShardedSegment));
+    layout.ranks[0] = arrays;
+    layout.ranks[1] = arrays + n;
+    layout.contrib = arrays + 2 * (size_t)n;
+    layout.dangling_partial = arrays + 3 * (size_t)n;
+    layout.residual_partial = layout.dangling_partial + PARTIAL_STRIDE * (size_t)shards;
+    return layout;
+}
+
+// Body of one worker process, it owns the nodes in [begin, end)
+// Contributions of the other shards are read straight from the shared segment
+static void run_shard(const CsrGraph &graph, const PageRankOptions &options, ShardedLayout layout,
+                      int shard, int shards, int begin, int end)
+{
+    int n = graph.num_nodes;
+    double d = options.damping;
+
+    for (int it = 0; it < options.max_iterations; it++)
+    {
+        const double *ranks = layout.ranks[it % 2];
+        double *next = layout.ranks[(it + 1) % 2];
+
+        // Publish this shard's contributions
+        double dangling = 0.0;
+        for (int u = begin; u < end; u++)
+        {
+            int degree = graph.out_degree(u);
+            if (degree == 0)
+                dangling += ranks[u];
+            layout.contrib[u] = degree == 0 ? 0.0 : ranks[u] / degree;
+        }
+        layout.dangling_partial[shard * PARTIAL_STRIDE] = dangling;
+        pthread_barrier_wait(&layout.segment->barrier);
+
+        dangling = 0.0;
+        for (int s = 0; s < shards; s++)
+            dangling += layout.dangling_partial[s * PARTIAL_STRIDE];
+
+        double base = (1.0 - d) / n + d * dangling / n;
+        double residual = 0.0;
+        for (int v = begin; v < end; v++)
+        {
+            next[v] = base + d * spmv_row<PlusTimes<double>>(graph, layout.contrib, v);
+            residual += fabs(next[v] - ranks[v]);
+        }
+        layout.residual_partial[shard * PARTIAL_STRIDE] = residual;
+        pthread_barrier_wait(&layout.segment->barrier);
+
+        // Every worker sums the same partials, so they all stop at the same iteration
+        residual = 0.0;
+        for (int s = 0; s < shards; s++)
+            residual += layout.residual_partial[s * PARTIAL_STRIDE];
+
+        if (shard == 0)
+        {
+            layout.segment->iterations = it + 1;
+            layout.segment->residual = residual;
+        }
+        if (residual < options.tolerance)
+        {
+            if (shard == 0)
+                layout.segment->converged = 1;
+            break;
+        }
+    }
+}
+
+bool PageRank::run_sharded(const CsrGraph &graph, int num_shards)
+{
+    this->stats = PageRankStats();
+    this->stats.tolerance = this->options.tolerance;
+    int n = graph.num_nodes;
+    int shards = max(1, min(num_shards, n));
+    this->ranks.assign(n, n > 0 ? 1.0 / n : 0.0);
+    if (n == 0)
+    {
+        this->stats.converged = true;
+        return true;
+    }
+
+    // The name is unlinked as soon as it is mapped, forked workers inherit the mapping
+    string name = "/pagerank_" + to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        std::cout << "ERROR::SHARDED::SHM_OPEN_FAILED\n"
+                  << name << std::endl;
+        return false;
+    }
+
+    size_t size = segment_size(n, shards);
+    void *memory = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    shm_unlink(name.c_str());
+    if (memory == MAP_FAILED)
+    {
+        std::cout << "ERROR::SHARDED::MMAP_FAILED" << std::endl;
+        return false;
+    }
+
+    ShardedLayout layout = map_layout(memory, n, shards);
+    layout.segment->iterations = 0;
+    layout.segment->converged = 0;
+    layout.segment->residual = 0.0;
+    for (int v = 0; v < n; v++)
+        layout.ranks[0][v] = this->ranks[v];
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&layout.segment->barrier, &attr, shards);
+    pthread_barrierattr_destroy(&attr);
+
+    vector<int> bounds = graph.partition(shards);
+    vector<pid_t> workers;
+    bool ok = true;
+    for (int s = 0; s < shards; s++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            run_shard(graph, this->options, layout, s, shards, bounds[s], bounds[s + 1]);
+            _exit(0);
+        }
+        if (pid < 0)
+        {
+            std::cout << "ERROR::SHARDED::FORK_FAILED" << std::endl;
+            ok = false;
+            // Workers already started would wait on the barrier forever
+            for (pid_t worker : workers)
+                kill(worker, SIGKILL);
+            break;
+        }
+        workers.push_back(pid);
+    }
+
+    // Only our own workers are reaped, a bare wait() could take a child started
+    // elsewhere in the process. They are polled so that a worker that dies,
+    // which would leave the others stuck on the barrier, takes them all down
+    vector<pid_t> running = workers;
+    while (!running.empty())
+    {
+        bool reaped = false;
+        for (int i = 0; i < running.size();)
+        {
+            int status = 0;
+            pid_t pid = waitpid(running[i], &status, WNOHANG);
+            if (pid == 0 || (pid < 0 && errno == EINTR))
+            {
+                i++;
+                continue;
+            }
+            running.erase(running.begin() + i);
+            reaped = true;
+            if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                if (ok)
+                {
+                    std::cout << "ERROR::SHARDED::WORKER_FAILED" << std::endl;
+                    for (pid_t worker : running)
+                        kill(worker, SIGKILL);
+                }
+                ok = false;
+            }
+        }
+        if (!reaped && !running.empty())
+            this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    if (ok)
+    {
+        int iterations = layout.segment->iterations;
+        const double *result = layout.ranks[iterations % 2];
+        for (int v = 0; v < n; v++)
+            this->ranks[v] = result[v];
+        this->stats.iterations = iterations;
+        this->stats.residual = layout.segment->residual;
+        this->stats.converged = layout.segment->converged;
+        this->stats.edges_processed = (int64_t)iterations * graph.num_edges();
+    }
+
+    pthread_barrier_destroy(&layout.segment->barrier);
+    munmap(memory, size);
+    return ok;
+}
+
+#else
+
+bool PageRank::run_sharded(const CsrGraph &graph, int num_shards)
+{
+    std::cout << "ERROR::SHARDED::UNSUPPORTED_PLATFORM" << std::endl;
+    return false;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef SPMV_H
+#define SPMV_H
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "csr_graph.h"
+
+using namespace std;
+
+// Generic sparse matrix-vector product over the CSR graph
+// For every node v the kernel reduces the values x[u] of the neighbors u of v:
+//     acc(v) = add over (u, v) of multiply(x[u], weight(u))
+// Semiring, weighting and direction are template parameters, so each
+// algorithm gets its own specialized loop without per-edge branches
+// A semiring's storage_type is the type of the input vector and value_type
+// the one the reduction is carried out in
+
+// (+, *) over T: PageRank, HITS, Katz
+// A narrower Storage (e.g. float) halves the bytes gathered per edge while
+// the sums are still accumulated in T
+template <typename T, typename Storage = T>
+struct PlusTimes
+{
+    typedef T value_type;
+    typedef Storage storage_type;
+    static T zero() { return T(0); }
+    static T one() { return T(1); }
+    static T add(T a, T b) { return a + b; }
+    static T multiply(T a, T b) { return a * b; }
+};
+
+// (min, +) over T: shortest paths, BFS levels
+template <typename T>
+struct MinPlus
+{
+    typedef T value_type;
+    typedef T storage_type;
+    static T zero() { return numeric_limits<T>::max(); }
+    static T one() { return T(0); }
+    static T add(T a, T b) { return min(a, b); }
+    // Saturates so that zero() stays the "unreachable" value
+    static T multiply(T a, T b) { return a == zero() || b == zero() ? zero() : a + b; }
+};
+
+// (or, and) over bytes: reachability, BFS frontiers
+struct OrAnd
+{
+    typedef uint8_t value_type;
+    typedef uint8_t storage_type;
+    static uint8_t zero() { return 0; }
+    static uint8_t one() { return 1; }
+    static uint8_t add(uint8_t a, uint8_t b) { return a | b; }
+    static uint8_t multiply(uint8_t a, uint8_t b) { return a & b; }
+};
+
+// Every edge has the semiring's identity weight
+struct UnitWeight
+{
+    template <typename Semiring>
+    static typename Semiring::value_type weight(const CsrGraph &, int)
+    {
+        return Semiring::one();
+    }
+};
+
+// Edges leaving u weigh 1 / out_degree(u), the random surfer transition
+struct InverseOutDegree
+{
+    template <typename Semiring>
+    static typename Semiring::value_type weight(const CsrGraph &graph, int u)
+    {
+        return typename Semiring::value_type(1) / graph.out_degree(u);
+    }
+};
+
+// Every edge counts as one hop, for min-plus path lengths
+struct HopWeight
+{
+    template <typename Semiring>
+    static typename Semiring::value_type weight(const CsrGraph &, int)
+    {
+        return typename Semiring::value_type(1);
+    }
+};
+
+enum class EdgeDirection
+{
+    // Reduce over in-neighbors, y = A^T x
+    IN,
+    // Reduce over out-neighbors, y = A x
+    OUT
+};
+
+// Reduce the row of node v
+template <typename Semiring, typename Weight = UnitWeight, EdgeDirection Dir = EdgeDirection::IN>
+inline typename Semiring::value_type spmv_row(const CsrGraph &graph, const typename Semiring::storage_type *x, int v)
+{
+    const vector<int64_t> &offsets = Dir == EdgeDirection::IN ? graph.in_offsets : graph.out_offsets;
+    const vector<int> &neighbors = Dir == EdgeDirection::IN ? graph.in_sources : graph.out_targets;
+
+    typename Semiring::value_type acc = Semiring::zero();
+    for (int64_t e = offsets[v]; e < offsets[v + 1]; e++)
+    {
+        int u = neighbors[e];
+        typename Semiring::value_type value = x[u];
+        acc = Semiring::add(acc, Semiring::multiply(value, Weight::template weight<Semiring>(graph, u)));
+    }
+    return acc;
+}
+
+// Reduce every row in parallel and hand the result to row(v, acc)
+// The doubles returned by row are summed, e.g. to get a residual in the same pass
+template <typename Semiring, typename Weight = UnitWeight, EdgeDirection Dir = EdgeDirection::IN, typename Row>
+double spmv(const CsrGraph &graph, const typename Semiring::storage_type *x, Row row)
+{
+    double total = 0.0;
+#pragma omp parallel for reduction(+ : total) schedule(dynamic, 1024)
+    for (int v = 0; v < graph.num_nodes; v++)
+    {
+        total += row(v, spmv_row<Semiring, Weight, Dir>(graph, x, v));
+    }
+    return total;
+}
+
+// y = A^T x (or A x for EdgeDirection::OUT) over the semiring
+template <typename Semiring, typename Weight = UnitWeight, EdgeDirection Dir = EdgeDirection::IN>
+void spmv(const CsrGraph &graph, const vector<typename Semiring::storage_type> &x, vector<typename Semiring::value_type> &y)
+{
+    y.resize(graph.num_nodes);
+    auto store = [&](int v, typename Semiring::value_type acc)
+    {
+        y[v] = acc;
+        return 0.0;
+    };
+    spmv<Semiring, Weight, Dir>(graph, x.data(), store);
+}
+#endif
@@ -0,0 +1,179 @@
+#include "temporal_pagerank.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+TemporalPageRank::TemporalPageRank(int num_nodes, int64_t window, PageRankOptions options)
+    : options{options}, num_nodes{num_nodes}, window{window}, clock{numeric_limits<int64_t>::min()}, mass{0.0}
+{
+    this->out_targets.resize(num_nodes);
+    this->estimate.assign(num_nodes, 0.0);
+    this->residual.assign(num_nodes, 0.0);
+    this->is_pending.assign(num_nodes, 0);
+
+    // Without edges every node only has its teleport share
+    for (int v = 0; v < num_nodes; v++)
+        add_residual(v, (1.0 - options.damping) / num_nodes);
+    push();
+}
+
+bool TemporalPageRank::add_edges(vector<TimedEdge> edges)
+{
+    for (const TimedEdge &edge : edges)
+    {
+        if (edge.source < 0 || edge.source >= this->num_nodes || edge.target < 0 || edge.target >= this->num_nodes)
+        {
+            std::cout << "ERROR::TEMPORAL::UNKNOWN_NODE\n"
+                      << edge.source << " -> " << edge.target << std::endl;
+            return false;
+        }
+    }
+
+    stable_sort(edges.begin(), edges.end(), [](const TimedEdge &a, const TimedEdge &b)
+                { return a.time < b.time; });
+    if (!edges.empty() && edges.front().time < this->clock)
+    {
+        std::cout << "ERROR::TEMPORAL::OUT_OF_ORDER\n"
+                  << "edge at " << edges.front().time << " is older than the clock " << this->clock << std::endl;
+        return false;
+    }
+
+    for (const TimedEdge &edge : edges)
+    {
+        this->live.push_back(edge);
+        insert_edge(edge.source, edge.target);
+    }
+    this->stats.edges_inserted += edges.size();
+
+    if (!edges.empty())
+        this->clock = edges.back().time;
+    expire();
+    push();
+    return true;
+}
+
+void TemporalPageRank::advance(int64_t now)
+{
+    if (now <= this->clock)
+        return;
+    this->clock = now;
+    expire();
+    push();
+}
+
+int64_t TemporalPageRank::now() const
+{
+    return this->clock;
+}
+
+int64_t TemporalPageRank::num_edges() const
+{
+    return this->live.size();
+}
+
+double TemporalPageRank::score(int v) const
+{
+    return this->estimate[v] / this->mass;
+}
+
+vector<double> TemporalPageRank::ranks() const
+{
+    // Summed afresh rather than using mass, which drifts over many updates
+    double total = accumulate(this->estimate.begin(), this->estimate.end(), 0.0);
+    vector<double> result(this->num_nodes);
+    for (int v = 0; v < this->num_nodes; v++)
+        result[v] = this->estimate[v] / total;
+    return result;
+}
+
+// Invariant kept for every node v:
+//     estimate[v] + residual[v] = (1 - d) / n + d * sum over (u, v) of estimate[u] / out_degree(u)
+// Changing the out-degree of u would touch every out-neighbor of u, so instead
+// estimate[u] is rescaled to keep estimate[u] / out_degree(u) as it was, and the
+// rescaling is moved into residual[u]. Only u and the edge target change
+void TemporalPageRank::insert_edge(int u, int w)
+{
+    double d = this->options.damping;
+    int k = this->out_targets[u].size();
+    double share = k > 0 ? this->estimate[u] / k : this->estimate[u];
+    if (k > 0)
+    {
+        this->estimate[u] += share;
+        this->mass += share;
+        add_residual(u, -share);
+    }
+    add_residual(w, d * share);
+    this->out_targets[u].push_back(w);
+}
+
+void TemporalPageRank::remove_edge(int u, int w)
+{
+    double d = this->options.damping;
+    vector<int> &targets = this->out_targets[u];
+    double share = this->estimate[u] / targets.size();
+    this->estimate[u] -= share;
+    this->mass -= share;
+    add_residual(u, share);
+    add_residual(w, -d * share);
+
+    // Parallel edges are interchangeable, drop any one of them
+    auto it = find(targets.begin(), targets.end(), w);
+    *it = targets.back();
+    targets.pop_back();
+}
+
+void TemporalPageRank::expire()
+{
+    while (!this->live.empty() && this->live.front().time <= this->clock - this->window)
+    {
+        remove_edge(this->live.front().source, this->live.front().target);
+        this->live.pop_front();
+        this->stats.edges_expired++;
+    }
+}
+
+void TemporalPageRank::add_residual(int v, double delta)
+{
+    this->residual[v] += delta;
+    if (!this->is_pending[v] && fabs(this->residual[v]) > this->options.tolerance / this->num_nodes)
+    {
+        this->is_pending[v] = 1;
+        this->pending.push_back(v);
+    }
+}
+
+// Residuals may be negative after removals, pushing them works the same way
+// Every push shrinks the total |residual| by at least (1 - d) * |residual[v]|
+void TemporalPageRank::push()
+{
+    double d = this->options.damping;
+    double threshold = this->options.tolerance / this->num_nodes;
+    while (!this->pending.empty())
+    {
+        int v = this->pending.front();
+        this->pending.pop_front();
+        this->is_pending[v] = 0;
+
+        double r = this->residual[v];
+        if (fabs(r) <= threshold)
+            continue;
+        this->residual[v] = 0.0;
+        this->estimate[v] += r;
+        this->mass += r;
+        this->stats.pushes++;
+
+        // Dangling nodes drop their mass, it comes back through the normalization
+        const vector<int> &targets = this->out_targets[v];
+        if (targets.empty())
+            continue;
+        double share = d * r / targets.size();
+        for (int w : targets)
+            add_residual(w, share);
+        this->stats.edges_processed += targets.size();
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TEMPORAL_PAGERANK_H
+#define TEMPORAL_PAGERANK_H
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "edge_file.h"
+#include "pagerank.h"
+
+using namespace std;
+
+struct TemporalStats
+{
+    int64_t edges_inserted = 0;
+    int64_t edges_expired = 0;
+    // Residual pushes and out-edges they went through, over the whole lifetime
+    int64_t pushes = 0;
+    int64_t edges_processed = 0;
+};
+
+// PageRank of the edges seen in the last window time units, (now - window, now]
+// Scores are kept up to date by local residual pushes instead of recomputation:
+// each inserted or expired edge only disturbs the residuals of its endpoints,
+// and only nodes whose residual exceeds tolerance / num_nodes are pushed again
+// The remaining residuals sum to at most tolerance, so the unnormalized scores
+// are within tolerance / (1 - damping) in L1 after every update
+// The unnormalized scores p solve p = (1 - d) / n + d * P^T p with dangling
+// mass dropped, which normalized is exactly PageRank with uniform dangling
+class TemporalPageRank
+{
+public:
+    PageRankOptions options;
+    TemporalStats stats;
+
+    TemporalPageRank(int num_nodes, int64_t window, PageRankOptions options);
+
+    // Insert a batch of edges, move the clock to the latest timestamp, expire
+    // the edges that fell out of the window and bring the scores up to date
+    // Returns false without changing anything if the batch goes back in time
+    // or names an unknown node
+    bool add_edges(vector<TimedEdge> edges);
+
+    // Move the clock forward without new edges, expiring old ones
+    void advance(int64_t now);
+
+    int64_t now() const;
+    int64_t num_edges() const;
+
+    // Normalized score of one node, O(1)
+    double score(int v) const;
+    // Normalized scores of every node, they sum to 1
+    vector<double> ranks() const;
+
+private:
+    int num_nodes;
+    int64_t window;
+    int64_t clock;
+    // Live edges in time order, out_targets keeps one entry per live edge
+    deque<TimedEdge> live;
+    vector<vector<int>> out_targets;
+    vector<double> estimate;
+    vector<double> residual;
+    double mass;
+    // Nodes whose residual may exceed the push threshold
+    deque<int> pending;
+    vector<uint8_t> is_pending;
+
+    void insert_edge(int u, int w);
+    void remove_edge(int u, int w);
+    void expire();
+    void add_residual(int v, double delta);
+    void push();
+};
+#endif